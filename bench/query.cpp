@@ -0,0 +1,73 @@
+// Cold View versus cached Query iteration
+// xmake build becs_bench && xmake run becs_bench [entities] [iterations]
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+
+#include "World.hpp"
+#include "components/components.hpp"
+
+using Clock = std::chrono::steady_clock;
+
+template<typename Func>
+double nsPerEntity(Func func, int iterations, std::size_t entities)
+{
+    const auto start = Clock::now();
+    for (int i = 0; i < iterations; i++) {
+        func();
+    }
+    const std::chrono::duration<double, std::nano> elapsed = Clock::now() - start;
+    return elapsed.count() / iterations / static_cast<double>(entities);
+}
+
+int main(int argc, char **argv)
+{
+    const int count = argc > 1 ? std::atoi(argv[1]) : 100000;
+    const int iterations = argc > 2 ? std::atoi(argv[2]) : 100;
+
+    World world;
+    world.registerComponent<CPosition>().registerComponent<CVelocity>().registerComponent<CCircle>();
+    for (int i = 0; i < count; i++) {
+        auto entity = world.createEntity();
+        world.Entityadd(entity, CPosition {float(i), 0.0f}, CVelocity {1.0f, 1.0f});
+        if (i % 3 != 0) {
+            world.EntityaddComponent(entity, CCircle {1.0f});
+        }
+    }
+
+    float sum = 0.0f;
+    auto kernel = [&sum](Entity, CPosition::Ref pos, CVelocity::Ref vel, CCircle &circle) {
+        sum += pos.x * vel.vx + circle.radius;
+    };
+    auto &query = world.getQuery<CPosition, CVelocity, CCircle>();
+    const std::size_t matching = query.size();
+
+    const double view = nsPerEntity(
+        [&] {
+            world.getView<CPosition, CVelocity, CCircle>().each(kernel);
+        },
+        iterations, matching
+    );
+    const double warm = nsPerEntity(
+        [&] {
+            query.each(kernel);
+        },
+        iterations, matching
+    );
+    // one structural change per iteration, the query falls back to its view every time
+    const double cold = nsPerEntity(
+        [&] {
+            world.EntityaddComponent(world.createEntity(), CPosition {0.0f, 0.0f});
+            query.each(kernel);
+        },
+        iterations, matching
+    );
+
+    std::printf("%zu matching entities, %d iterations\n", matching, iterations);
+    std::printf("view (no cache)     : %6.2f ns/entity\n", view);
+    std::printf("query warm          : %6.2f ns/entity\n", warm);
+    std::printf("query churned       : %6.2f ns/entity\n", cold);
+    std::printf("rebuilds: %zu, checksum %f\n", query.getRebuilds(), sum);
+    return 0;
+}
@@ -0,0 +1,338 @@
+
+// Headless simulation driver, for load tests on machines without a display
+// xmake build becs_sim && xmake run becs_sim --balls 100000 --churn 0.01 --ticks 1000 --threads 8
+//
+// every tick applies a batch of commands (despawn/spawn balls, 1 in 16 static, drawn from a seeded RNG),
+// then runs the movement and collision systems; reports ticks/s, tick latency percentiles and the peak RSS.
+// --record file saves the commands and a World::hash() per tick, --replay file runs them again and
+// reports the first tick whose hash differs (with any --threads, the world runs in deterministic mode).
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <numeric>
+#include <random>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <sys/resource.h>
+#endif
+
+#include "Replay.hpp"
+#include "World.hpp"
+#include "systems/systems.hpp"
+#include "utils/bytes.hpp"
+
+using Clock = std::chrono::steady_clock;
+
+struct Options {
+    std::size_t balls = 10000;
+    double churn = 0.01; // fraction of the balls despawned and respawned every tick
+    std::size_t ticks = 1000;
+    std::size_t threads = 1;
+    std::uint64_t seed = 42;
+    std::string record;
+    std::string replay;
+};
+
+// a ball to create, copied as is in the command bytes
+struct SpawnCommand {
+    float x, y, vx, vy, radius;
+    std::uint32_t color;
+    std::uint32_t isStatic; // CStatic: doesn't move, still bounces
+};
+
+// [u32 despawn count][u64 entity id]...[u32 spawn count][SpawnCommand]...
+class Commands {
+private:
+    std::vector<std::byte> bytes;
+
+public:
+    Commands(const std::vector<Entity> &despawns, const std::vector<SpawnCommand> &spawns)
+    {
+        writeBytes(bytes, static_cast<std::uint32_t>(despawns.size()));
+        for (Entity entity : despawns) {
+            writeBytes(bytes, static_cast<std::uint64_t>(entity.getId()));
+        }
+        writeBytes(bytes, static_cast<std::uint32_t>(spawns.size()));
+        for (const auto &spawn : spawns) {
+            writeBytes(bytes, spawn);
+        }
+    }
+
+    std::span<const std::byte> getBytes() const { return bytes; }
+
+    static void parse(
+        std::span<const std::byte> bytes, std::vector<Entity> &despawns, std::vector<SpawnCommand> &spawns
+    )
+    {
+        std::size_t offset = 0;
+        const auto despawnCount = readBytes<std::uint32_t>(bytes, offset);
+        for (std::uint32_t i = 0; i < despawnCount; i++) {
+            despawns.emplace_back(readBytes<std::uint64_t>(bytes, offset));
+        }
+        spawns.resize(readBytes<std::uint32_t>(bytes, offset));
+        for (auto &spawn : spawns) {
+            spawn = readBytes<SpawnCommand>(bytes, offset);
+        }
+    }
+};
+
+class Simulation {
+private:
+    static constexpr float width = 800.0f;
+    static constexpr float height = 600.0f;
+    static constexpr float deltaTime = 1.0f / 60.0f;
+
+    World world;
+    std::vector<Entity> balls; // creation order, despawns pick from it
+    std::unique_ptr<ThreadPool> pool;
+    SCollision collisionSystem {0.0f, 0.0f, width, height};
+
+    std::mt19937_64 rng;
+    double churnDebt = 0.0;
+
+    float uniform(float min, float max) { return std::uniform_real_distribution<float>(min, max)(rng); }
+
+    SpawnCommand randomBall()
+    {
+        const auto color = static_cast<std::uint32_t>(rng());
+        const std::uint32_t isStatic = rng() % 16 == 0;
+        return {uniform(10, width - 10), uniform(10, height - 10), uniform(-200, 200),
+                uniform(-200, 200), uniform(2, 3), color | 0xff000000, isStatic};
+    }
+
+public:
+    Simulation(std::uint64_t seed, std::size_t threads):
+        rng(seed)
+    {
+        world.registerComponent<CPosition>()
+            .registerComponent<CVelocity>()
+            .registerComponent<CCircle>()
+            .registerComponent<CShapeColor>()
+            .registerComponent<CStatic>();
+        world.getEvents().registerEvent<EWallBounce>();
+        world.setDeterministic(true);
+        if (threads > 1) {
+            pool = std::make_unique<ThreadPool>(threads);
+        }
+    }
+
+    // commands of the next tick: the initial balls on the first tick, then churn
+    Commands nextCommands(const Options &options)
+    {
+        std::vector<Entity> despawns;
+        std::vector<SpawnCommand> spawns;
+        if (balls.empty()) {
+            spawns.resize(options.balls);
+        } else {
+            churnDebt += static_cast<double>(options.balls) * options.churn;
+            const auto count = std::min(static_cast<std::size_t>(churnDebt), balls.size());
+            churnDebt -= static_cast<double>(count);
+
+            std::unordered_set<std::size_t> picked;
+            while (picked.size() < count) {
+                const std::size_t index = rng() % balls.size();
+                if (picked.insert(index).second) {
+                    despawns.push_back(balls[index]);
+                }
+            }
+            spawns.resize(count);
+        }
+        for (auto &spawn : spawns) {
+            spawn = randomBall();
+        }
+        return Commands(despawns, spawns);
+    }
+
+    void apply(std::span<const std::byte> commands)
+    {
+        std::vector<Entity> despawns;
+        std::vector<SpawnCommand> spawns;
+        Commands::parse(commands, despawns, spawns);
+
+        world.destroyEntities(despawns);
+        const std::unordered_set<std::size_t> removed = [&] {
+            std::unordered_set<std::size_t> ids;
+            for (Entity entity : despawns) {
+                ids.insert(entity.getId());
+            }
+            return ids;
+        }();
+        std::erase_if(balls, [&](Entity entity) {
+            return removed.contains(entity.getId());
+        });
+
+        for (const auto &spawn : spawns) {
+            Entity ball = world.createEntity();
+            CShapeColor color;
+            color.value = spawn.color;
+            world.Entityadd(
+                ball, CPosition {spawn.x, spawn.y}, CVelocity {spawn.vx, spawn.vy}, CCircle {spawn.radius},
+                color
+            );
+            if (spawn.isStatic) {
+                world.EntityaddComponent(ball, CStatic {});
+            }
+            balls.push_back(ball);
+        }
+    }
+
+    void tick()
+    {
+        auto &bounces = world.getEvents().getChannel<EWallBounce>();
+        auto movement = SMovement::kernel(deltaTime);
+        auto collision = collisionSystem.circleKernel(bounces);
+        // the same pass either way, so that replays compare sequential and parallel runs
+        if (pool) {
+            parallelFuse(world, *pool, movement, collision);
+        } else {
+            fuse(world, movement, collision);
+        }
+        world.endFrame();
+    }
+
+    std::uint64_t hash() const { return world.hash(); }
+
+    std::size_t getEntityCount() const { return world.getEntityCount(); }
+};
+
+// peak resident set size in KiB, 0 where getrusage() is not available
+std::size_t peakRssKb()
+{
+#if defined(__APPLE__)
+    rusage usage {};
+    getrusage(RUSAGE_SELF, &usage);
+    return static_cast<std::size_t>(usage.ru_maxrss) / 1024;
+#elif defined(__unix__)
+    rusage usage {};
+    getrusage(RUSAGE_SELF, &usage);
+    return static_cast<std::size_t>(usage.ru_maxrss);
+#else
+    return 0;
+#endif
+}
+
+double percentile(const std::vector<double> &sorted, double p)
+{
+    if (sorted.empty()) {
+        return 0.0;
+    }
+    const auto index = static_cast<std::size_t>(p * static_cast<double>(sorted.size() - 1) + 0.5);
+    return sorted[index];
+}
+
+Options parseOptions(int argc, char **argv)
+{
+    Options options;
+    for (int i = 1; i < argc; i++) {
+        const std::string name = argv[i];
+        if (i + 1 >= argc) {
+            throw std::runtime_error("Missing value for " + name);
+        }
+        const std::string value = argv[++i];
+        if (name == "--balls") {
+            options.balls = std::stoull(value);
+        } else if (name == "--churn") {
+            options.churn = std::stod(value);
+            if (!(options.churn >= 0.0)) {
+                throw std::runtime_error("--churn must not be negative");
+            }
+        } else if (name == "--ticks") {
+            options.ticks = std::stoull(value);
+            if (options.ticks == 0) {
+                throw std::runtime_error("--ticks must be at least 1");
+            }
+        } else if (name == "--threads") {
+            options.threads = std::max<std::size_t>(1, std::stoull(value));
+        } else if (name == "--seed") {
+            options.seed = std::stoull(value);
+        } else if (name == "--record") {
+            options.record = value;
+        } else if (name == "--replay") {
+            options.replay = value;
+        } else {
+            throw std::runtime_error("Unknown option " + name);
+        }
+    }
+    return options;
+}
+
+int replay(const Options &options)
+{
+    const ReplayLog log = ReplayLog::load(options.replay);
+    Simulation simulation(log.getSeed(), options.threads);
+    const auto desync = log.verify([&](std::span<const std::byte> commands) {
+        simulation.apply(commands);
+        simulation.tick();
+        return simulation.hash();
+    });
+    if (desync) {
+        std::printf("desync at tick %zu of %zu\n", *desync, log.size());
+        return 1;
+    }
+    std::printf("replay ok: %zu ticks, %zu entities\n", log.size(), simulation.getEntityCount());
+    return 0;
+}
+
+int run(const Options &options)
+{
+    Simulation simulation(options.seed, options.threads);
+    ReplayLog log(options.seed);
+    std::vector<double> latencies; // ms
+    latencies.reserve(options.ticks);
+
+    for (std::size_t tick = 0; tick < options.ticks; tick++) {
+        const Commands commands = simulation.nextCommands(options);
+        const auto tickStart = Clock::now();
+        simulation.apply(commands.getBytes());
+        simulation.tick();
+        latencies.push_back(std::chrono::duration<double, std::milli>(Clock::now() - tickStart).count());
+        // hashing walks the whole world, it is not part of the tick latency
+        if (!options.record.empty()) {
+            log.record(commands.getBytes(), simulation.hash());
+        }
+    }
+    // ticks/s only counts the ticks themselves, not the command generation and the hashing
+    const double tickSeconds = std::accumulate(latencies.begin(), latencies.end(), 0.0) / 1000.0;
+
+    if (!options.record.empty()) {
+        log.save(options.record);
+    }
+
+    std::sort(latencies.begin(), latencies.end());
+    std::printf(
+        "%zu balls, churn %.4f, %zu ticks, %zu threads, seed %llu\n", options.balls, options.churn,
+        options.ticks, options.threads, static_cast<unsigned long long>(options.seed)
+    );
+    std::printf("ticks/s          : %.1f\n", static_cast<double>(options.ticks) / tickSeconds);
+    std::printf(
+        "tick latency (ms): p50 %.3f, p95 %.3f, p99 %.3f, max %.3f\n", percentile(latencies, 0.50),
+        percentile(latencies, 0.95), percentile(latencies, 0.99), latencies.empty() ? 0.0 : latencies.back()
+    );
+    std::printf("peak RSS         : %zu KiB\n", peakRssKb());
+    std::printf("entities         : %zu, hash %016llx\n", simulation.getEntityCount(),
+                static_cast<unsigned long long>(simulation.hash()));
+    return 0;
+}
+
+int main(int argc, char **argv)
+{
+    try {
+        const Options options = parseOptions(argc, argv);
+        return options.replay.empty() ? run(options) : replay(options);
+    } catch (const std::exception &error) {
+        std::fprintf(stderr, "%s\n", error.what());
+        std::fprintf(
+            stderr, "usage: becs_sim [--balls N] [--churn fraction] [--ticks N] [--threads N] [--seed N]\n"
+                    "                [--record file | --replay file]\n"
+        );
+        return 1;
+    }
+}
@@ -0,0 +1,248 @@
+
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <coroutine>
+#include <deque>
+#include <exception>
+#include <mutex>
+#include <optional>
+#include <type_traits>
+#include <utility>
+#include <variant>
+#include <vector>
+
+#include "utils/ThreadPool.hpp"
+
+class AsyncScheduler;
+
+// Coroutine type of async systems, for work spread across several frames
+//
+// AsyncTask rebuildIndex(World &world)
+// {
+//     for (auto entity : world.getTable<CPosition>().getEntities()) {
+//         EntityRef ref(world, entity);
+//         co_await WithinBudget {};        // continues next frame if the frame budget is spent
+//         if (auto *pos = ref.get<CPosition>()) { ... }
+//     }
+//     auto path = co_await RunOn(pool, [] { return computePath(); }); // off the frame thread
+//     co_await NextFrame {};
+// }
+// scheduler.spawn(rebuildIndex(world));
+// ...
+// scheduler.update(std::chrono::milliseconds(2)); // in the frame loop
+//
+// the coroutine body always runs on the thread calling AsyncScheduler::update()
+class AsyncTask {
+public:
+    struct promise_type {
+        AsyncScheduler *scheduler = nullptr;
+        std::exception_ptr error;
+
+        AsyncTask get_return_object() { return AsyncTask(handle::from_promise(*this)); }
+        std::suspend_always initial_suspend() noexcept { return {}; }
+        std::suspend_always final_suspend() noexcept { return {}; }
+        void return_void() {}
+        void unhandled_exception() { error = std::current_exception(); }
+    };
+    using handle = std::coroutine_handle<promise_type>;
+
+    explicit AsyncTask(handle coroutine):
+        coroutine(coroutine)
+    {
+    }
+    ~AsyncTask()
+    {
+        if (coroutine) {
+            coroutine.destroy();
+        }
+    }
+    AsyncTask(const AsyncTask &other) = delete;
+    AsyncTask(AsyncTask &&other) noexcept :
+        coroutine(std::exchange(other.coroutine, nullptr))
+    {
+    }
+    AsyncTask &operator=(const AsyncTask &other) = delete;
+    AsyncTask &operator=(AsyncTask &&other) noexcept
+    {
+        std::swap(coroutine, other.coroutine);
+        return *this;
+    }
+
+    bool done() const { return coroutine.done(); }
+
+private:
+    friend class AsyncScheduler;
+    handle coroutine;
+};
+
+// Resumes the async systems from the frame loop, within a time budget per frame
+class AsyncScheduler {
+public:
+    using Clock = std::chrono::steady_clock;
+
+private:
+    std::vector<AsyncTask> tasks;
+    std::deque<std::coroutine_handle<>> ready;
+    std::vector<std::coroutine_handle<>> waitingFrame;
+    Clock::time_point deadline;
+
+    // thread pool jobs push their coroutine here once they are done
+    std::mutex completedMutex;
+    std::vector<std::coroutine_handle<>> completed;
+    // RunOn jobs still running, they write into the coroutine frames owned by tasks
+    std::size_t running = 0;
+    std::condition_variable runningDone;
+
+    friend struct NextFrame;
+    friend struct WithinBudget;
+    template<typename Func>
+    friend struct RunOn;
+
+public:
+    AsyncScheduler() = default;
+    // waits for the RunOn jobs still running before destroying the tasks
+    ~AsyncScheduler()
+    {
+        std::unique_lock<std::mutex> lock(completedMutex);
+        runningDone.wait(lock, [this] {
+            return running == 0;
+        });
+    }
+    AsyncScheduler(const AsyncScheduler &other) = delete;
+    AsyncScheduler &operator=(const AsyncScheduler &other) = delete;
+
+    void spawn(AsyncTask task)
+    {
+        task.coroutine.promise().scheduler = this;
+        ready.push_back(task.coroutine);
+        tasks.push_back(std::move(task));
+    }
+
+    // resumes ready tasks until there are none left or the budget is spent
+    // tasks still ready when the budget runs out keep their turn for the next frame
+    // rethrows the first exception that escaped a task, the other failed tasks are kept and their
+    // exceptions rethrown by the next updates, one per update
+    void update(Clock::duration budget)
+    {
+        deadline = Clock::now() + budget;
+        ready.insert(ready.end(), waitingFrame.begin(), waitingFrame.end());
+        waitingFrame.clear();
+        {
+            std::lock_guard<std::mutex> lock(completedMutex);
+            ready.insert(ready.end(), completed.begin(), completed.end());
+            completed.clear();
+        }
+
+        while (!ready.empty() && Clock::now() < deadline) {
+            auto coroutine = ready.front();
+            ready.pop_front();
+            coroutine.resume();
+        }
+
+        std::exception_ptr error;
+        std::erase_if(tasks, [&error](const AsyncTask &task) {
+            if (!task.done()) {
+                return false;
+            }
+            const std::exception_ptr &failure = task.coroutine.promise().error;
+            if (!failure) {
+                return true;
+            }
+            if (error) {
+                return false;
+            }
+            error = failure;
+            return true;
+        });
+        if (error) {
+            std::rethrow_exception(error);
+        }
+    }
+
+    std::size_t pending() const { return tasks.size(); }
+
+    bool overBudget() const { return Clock::now() >= deadline; }
+};
+
+// co_await NextFrame {}: suspends until the next AsyncScheduler::update()
+struct NextFrame {
+    bool await_ready() const noexcept { return false; }
+    void await_suspend(AsyncTask::handle coroutine) const
+    {
+        coroutine.promise().scheduler->waitingFrame.push_back(coroutine);
+    }
+    void await_resume() const noexcept {}
+};
+
+// co_await WithinBudget {}: continues right away, unless the frame budget is spent
+struct WithinBudget {
+    bool await_ready() const noexcept { return false; }
+    bool await_suspend(AsyncTask::handle coroutine) const
+    {
+        auto *scheduler = coroutine.promise().scheduler;
+        if (!scheduler->overBudget()) {
+            return false;
+        }
+        scheduler->waitingFrame.push_back(coroutine);
+        return true;
+    }
+    void await_resume() const noexcept {}
+};
+
+// co_await RunOn(pool, func): runs func on the thread pool, the task is resumed
+// by the first AsyncScheduler::update() after func returned, and gets its result
+// func must not touch the World, it runs concurrently with the frame
+// destroying the AsyncScheduler blocks until every func running has returned
+template<typename Func>
+struct RunOn {
+    using Result = std::invoke_result_t<Func>;
+    using Storage = std::conditional_t<std::is_void_v<Result>, std::monostate, std::optional<Result>>;
+
+    ThreadPool &pool;
+    Func func;
+    Storage result;
+    std::exception_ptr error;
+
+    RunOn(ThreadPool &pool, Func func):
+        pool(pool),
+        func(std::move(func))
+    {
+    }
+
+    bool await_ready() const noexcept { return false; }
+    void await_suspend(AsyncTask::handle coroutine)
+    {
+        auto *scheduler = coroutine.promise().scheduler;
+        {
+            std::lock_guard<std::mutex> lock(scheduler->completedMutex);
+            scheduler->running++;
+        }
+        pool.enqueue([this, scheduler, coroutine] {
+            try {
+                if constexpr (std::is_void_v<Result>) {
+                    func();
+                } else {
+                    result.emplace(func());
+                }
+            } catch (...) {
+                error = std::current_exception();
+            }
+            std::lock_guard<std::mutex> lock(scheduler->completedMutex);
+            scheduler->completed.push_back(coroutine);
+            // notified under the lock, the scheduler can be destroyed as soon as it is released
+            scheduler->running--;
+            scheduler->runningDone.notify_all();
+        });
+    }
+    Result await_resume()
+    {
+        if (error) {
+            std::rethrow_exception(error);
+        }
+        if constexpr (!std::is_void_v<Result>) {
+            return std::move(*result);
+        }
+    }
+};
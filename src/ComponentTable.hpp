@@ -2,11 +2,30 @@
 #pragma once
 
 #include "Entity.hpp"
+#include "EntityOrder.hpp"
+#include "Observers.hpp"
+#include "PagedArray.hpp"
+#include "TableStats.hpp"
 #include <any>
+#include <array>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
 #include <functional>
 #include <iostream>
+#include <limits>
+#include <memory>
+#include <optional>
 #include <ostream>
+#include <ranges>
+#include <span>
+#include <stdexcept>
+#include <tuple>
+#include <type_traits>
+#include <typeinfo>
 #include <unordered_map>
+#include <utility>
 #include <vector>
 
 class IComponentTable {
@@ -17,6 +36,30 @@ public:
     // virtual std::any get(Entity entity) = 0;
     virtual void remove(Entity entity) = 0;
 
+    // moves the components of mapping[i].first to mapping[i].second in destination
+    // destination has to be a table of the same component type
+    virtual void
+    moveTo(IComponentTable &destination, const std::vector<std::pair<Entity, Entity>> &mapping) = 0;
+    virtual std::unique_ptr<IComponentTable> makeEmpty() const = 0;
+
+    // raw bytes of the component of entity appended to out, false if entity doesn't have it
+    // only works for trivially copyable components, the bytes are only valid for the same build
+    virtual bool serialize(Entity entity, std::vector<std::byte> &out) const = 0;
+    virtual void deserialize(Entity entity, std::span<const std::byte> data) = 0;
+    // bytes written by serialize() for one component, 0 for tags
+    virtual std::size_t serializedSize() const = 0;
+
+    virtual void observe(ObserverEvent event, Observer observer) = 0;
+    // sends the recorded changes to the observers
+    virtual void dispatchObservers() = 0;
+
+    // mangled type name, stable for a given build unlike the type hash
+    virtual const char *name() const = 0;
+    virtual TableStats stats() const = 0;
+    virtual void shrinkToFit() = 0;
+    // frame sync point, called by World::endFrame()
+    virtual void endFrame() = 0;
+
     friend std::ostream &operator<<(std::ostream &os, const IComponentTable &table)
     {
         table.print(os);
@@ -27,11 +70,147 @@ private:
     virtual void print(std::ostream &os) const = 0;
 };
 
+// component opting in columnar storage with DERIVE_COLUMNS (see utils/columns.hpp)
+template<typename C>
+concept Columnar = requires(C component) {
+    typename C::Ref;
+    component.get_columns();
+} && std::is_same_v<typename C::Ref::Component, C>;
+
+// proxy given by the views for columnar components
+template<typename R>
+concept ColumnRef = requires { typename R::Component; } && std::is_same_v<typename R::Component::Ref, R>;
+
+template<typename C>
+struct ComponentRefTraits {
+    using type = C &;
+    using pointer = C *;
+};
+
+template<Columnar C>
+struct ComponentRefTraits<C> {
+    using type = typename C::Ref;
+    using pointer = std::optional<typename C::Ref>;
+};
+
+// what views give for a component: Component & or Component::Ref
+template<typename C>
+using ComponentRef = typename ComponentRefTraits<C>::type;
+
+// what tryGet() gives for a component: Component * or std::optional<Component::Ref>
+template<typename C>
+using ComponentPtr = typename ComponentRefTraits<C>::pointer;
+
+// Bookkeeping shared by the table implementations: observers, id order, version and frame counters
+// Derived provides has(entity) and eachEntity(func), and reports its changes with added(), removed()
+// and updated().
+template<typename Derived, typename Component>
+class ComponentTableBase : public IComponentTable {
+protected:
+    ComponentObservers observers;
+    EntityOrder order;
+    std::size_t frameAdded = 0, frameRemoved = 0;
+    std::uint64_t version = 0;
+    std::size_t lastAdded = 0, lastRemoved = 0;
+
+    void added(Entity entity)
+    {
+        order.insert(entity);
+        frameAdded++;
+        version++;
+        observers.record(ObserverEvent::Add, entity);
+    }
+    void removed(Entity entity)
+    {
+        order.remove();
+        frameRemoved++;
+        version++;
+        observers.record(ObserverEvent::Remove, entity);
+    }
+    void updated(Entity entity) { observers.record(ObserverEvent::Update, entity); }
+
+    // stats with the name, the frame counters and the shared bookkeeping memory filled in
+    TableStats baseStats() const
+    {
+        TableStats stats;
+        stats.name = name();
+        stats.bytesReserved = order.bytes() + observers.bytes();
+        stats.added = lastAdded;
+        stats.removed = lastRemoved;
+        return stats;
+    }
+
+private:
+    Derived &self() { return static_cast<Derived &>(*this); }
+    const Derived &self() const { return static_cast<const Derived &>(*this); }
+
+public:
+    // notifies the update observers that the component of entity was modified in place
+    // records into an unsynchronized list: not from parallelEach() or parallelFuse() callbacks, mark the
+    // modified entities after the pass instead
+    void markUpdated(Entity entity) { updated(entity); }
+    // changes every time an entity is added or removed, components don't move in memory otherwise
+    std::uint64_t getVersion() const { return version; }
+
+    // entities sorted by id, see EntityOrder.hpp
+    const std::vector<Entity> &orderedEntities()
+    {
+        return order.get(
+            [this](Entity entity) {
+                return self().has(entity);
+            },
+            [this](auto func) {
+                self().eachEntity(func);
+            }
+        );
+    }
+
+    std::unique_ptr<IComponentTable> makeEmpty() const override { return std::make_unique<Derived>(); }
+
+    void observe(ObserverEvent event, Observer observer) override
+    {
+        observers.observe(event, std::move(observer));
+    }
+
+    void dispatchObservers() override
+    {
+        observers.dispatch([this](Entity entity) {
+            return self().has(entity);
+        });
+    }
+
+    const char *name() const override { return typeid(Component).name(); }
+
+    void endFrame() override
+    {
+        lastAdded = std::exchange(frameAdded, 0);
+        lastRemoved = std::exchange(frameRemoved, 0);
+    }
+
+    friend std::ostream &operator<<(std::ostream &os, const Derived &table)
+    {
+        table.print(os);
+        return os;
+    }
+};
+
 template<typename Component>
-class ComponentTable : public IComponentTable {
+class ComponentTable : public ComponentTableBase<ComponentTable<Component>, Component> {
 private:
+    using Base = ComponentTableBase<ComponentTable, Component>;
+    friend Base;
+    using Base::added;
+    using Base::removed;
+    using Base::updated;
+    using Base::version;
+    using Base::baseStats;
+
     std::unordered_map<Entity, Component> table;
 
+    // approximation of an unordered_map node: next pointer and the pair (hash isn't cached for Entity)
+    // in DEBUG the key holds the entity name, the heap buffer of long names is added by stats()
+    static constexpr std::size_t nodeBytes = sizeof(void *) + sizeof(std::pair<const Entity, Component>);
+
 public:
     using iterator = typename std::unordered_map<Entity, Component>::iterator;
     using const_iterator = typename std::unordered_map<Entity, Component>::const_iterator;
@@ -46,11 +225,34 @@ public:
 
     void add(Entity entity, const std::any &component) override
     {
-        table[entity] = std::any_cast<Component>(component);
+        insert(entity, std::any_cast<Component>(component));
+    }
+    void insert(Entity entity, Component component)
+    {
+        auto [it, inserted] = table.insert_or_assign(entity, std::move(component));
+        if (inserted) {
+            added(entity);
+        } else {
+            updated(entity);
+        }
     }
     bool has(Entity entity) const { return table.find(entity) != table.end(); }
-    Component &get(Entity entity) { return table[entity]; }
-    const Component &get(Entity entity) const { return table[entity]; }
+    // a missing component is default constructed, added like insert() would
+    Component &get(Entity entity)
+    {
+        auto it = table.find(entity);
+        if (it == table.end()) {
+            insert(entity, Component {});
+            it = table.find(entity);
+        }
+        return it->second;
+    }
+    Component *tryGet(Entity entity)
+    {
+        auto it = table.find(entity);
+        return it == table.end() ? nullptr : &it->second;
+    }
+    const Component &get(Entity entity) const { return table.at(entity); }
     std::vector<Entity> getEntities() const
     {
         std::vector<Entity> entities;
@@ -59,10 +261,25 @@ public:
         }
         return entities;
     }
-    void remove(Entity entity) override { table.erase(entity); }
+    void remove(Entity entity) override
+    {
+        if (table.erase(entity)) {
+            removed(entity);
+        }
+    }
+    std::size_t size() const { return table.size(); }
+    void reserve(std::size_t count) { table.reserve(count); }
     iterator begin() { return table.begin(); }
     iterator end() { return table.end(); }
 
+    template<typename Func>
+    void eachEntity(Func func) const
+    {
+        for (const auto &[entity, _] : table) {
+            func(entity);
+        }
+    }
+
     void each(std::function<void(Entity, Component &)> func)
     {
         for (auto &[entity, component] : table) {
@@ -70,6 +287,70 @@ public:
         }
     }
 
+    void moveTo(IComponentTable &destination, const std::vector<std::pair<Entity, Entity>> &mapping) override
+    {
+        auto &other = static_cast<ComponentTable &>(destination);
+        for (const auto &[from, to] : mapping) {
+            auto it = table.find(from);
+            if (it == table.end()) {
+                continue;
+            }
+            auto [_, inserted] = other.table.insert_or_assign(to, std::move(it->second));
+            if (inserted) {
+                other.added(to);
+            } else {
+                other.updated(to);
+            }
+            table.erase(it);
+            removed(from);
+        }
+    }
+
+    bool serialize(Entity entity, std::vector<std::byte> &out) const override
+    {
+        auto it = table.find(entity);
+        if (it == table.end()) {
+            return false;
+        }
+        if constexpr (std::is_trivially_copyable_v<Component>) {
+            const auto *bytes = reinterpret_cast<const std::byte *>(&it->second);
+            out.insert(out.end(), bytes, bytes + sizeof(Component));
+            return true;
+        } else {
+            throw std::runtime_error("Component is not trivially copyable");
+        }
+    }
+
+    void deserialize(Entity entity, std::span<const std::byte> data) override
+    {
+        if constexpr (std::is_trivially_copyable_v<Component> && std::is_default_constructible_v<Component>) {
+            if (data.size() != sizeof(Component)) {
+                throw std::runtime_error("Invalid component size");
+            }
+            Component component;
+            std::memcpy(&component, data.data(), sizeof(Component));
+            insert(entity, component);
+        } else {
+            throw std::runtime_error("Component is not trivially copyable");
+        }
+    }
+
+    std::size_t serializedSize() const override { return sizeof(Component); }
+
+    TableStats stats() const override
+    {
+        TableStats stats = baseStats();
+        stats.entities = table.size();
+        stats.capacity = static_cast<std::size_t>(table.bucket_count() * table.max_load_factor());
+        stats.bytesUsed = table.size() * sizeof(Component);
+        stats.bytesReserved += table.size() * nodeBytes + table.bucket_count() * sizeof(void *);
+        stats.bytesReserved += entityNameBytes(std::views::keys(table));
+        stats.fragmentation = table.bucket_count() ? 1.0f - table.load_factor() : 0.0f;
+        return stats;
+    }
+
+    void shrinkToFit() override { table.rehash(0); }
+
     void print(std::ostream &os) const override
     {
         os << "{\n";
@@ -78,10 +359,391 @@ public:
         }
         os << "}";
     }
+};
+
+// Tables of empty components (tags) don't store anything per entity, only a membership bit
+// indexed by the entity id. get() adds the entity if needed and returns the same shared instance for all.
+// The bits are paged (PagedArray.hpp, 4096 ids per page), pages without members are freed.
+template<typename Component>
+    requires std::is_empty_v<Component>
+class ComponentTable<Component> : public ComponentTableBase<ComponentTable<Component>, Component> {
+private:
+    using Base = ComponentTableBase<ComponentTable, Component>;
+    friend Base;
+    using Base::added;
+    using Base::removed;
+    using Base::updated;
+    using Base::version;
+    using Base::baseStats;
+
+    static constexpr std::size_t wordBits = 64;
+    static constexpr std::size_t pageWords = 64;
 
-    friend std::ostream &operator<<(std::ostream &os, const ComponentTable &table)
+    PagedArray<std::uint64_t, pageWords> bits; // word i holds the ids [i * wordBits, (i + 1) * wordBits)
+    std::size_t count = 0;
+    static inline Component instance {};
+
+public:
+    ComponentTable() = default;
+    ~ComponentTable() override = default;
+    ComponentTable(const ComponentTable &other) = default;
+    ComponentTable(ComponentTable &&other) noexcept = default;
+    ComponentTable &operator=(const ComponentTable &other) = default;
+    ComponentTable &operator=(ComponentTable &&other) noexcept = default;
+
+    void add(Entity entity, const std::any &) override
     {
-        table.print(os);
-        return os;
+        const std::size_t word = entity.getId() / wordBits;
+        const std::uint64_t mask = std::uint64_t {1} << (entity.getId() % wordBits);
+        if (!(bits.get(word) & mask)) {
+            bits.at(word) |= mask;
+            bits.retain(word);
+            count++;
+            added(entity);
+        }
+    }
+    bool has(Entity entity) const
+    {
+        const std::size_t word = entity.getId() / wordBits;
+        return (bits.get(word) >> (entity.getId() % wordBits)) & 1;
+    }
+    Component &get(Entity entity)
+    {
+        if (!has(entity)) {
+            add(entity, instance);
+        }
+        return instance;
+    }
+    Component *tryGet(Entity entity) { return has(entity) ? &instance : nullptr; }
+    const Component &get(Entity) const { return instance; }
+    std::vector<Entity> getEntities() const
+    {
+        std::vector<Entity> entities;
+        eachEntity([&entities](Entity entity) {
+            entities.push_back(entity);
+        });
+        return entities;
+    }
+    void remove(Entity entity) override
+    {
+        const std::size_t word = entity.getId() / wordBits;
+        const std::uint64_t mask = std::uint64_t {1} << (entity.getId() % wordBits);
+        if (bits.get(word) & mask) {
+            bits.at(word) &= ~mask;
+            bits.release(word);
+            count--;
+            removed(entity);
+        }
+    }
+    std::size_t size() const { return count; }
+    // reserves the page directory for entity ids up to count
+    void reserve(std::size_t count) { bits.reserve((count + wordBits - 1) / wordBits); }
+
+    template<typename Func>
+    void eachEntity(Func func) const
+    {
+        bits.eachPage([&func](std::size_t firstWord, const std::vector<std::uint64_t> &words) {
+            for (std::size_t word = 0; word < words.size(); word++) {
+                for (std::uint64_t rest = words[word]; rest != 0; rest &= rest - 1) {
+                    func(Entity((firstWord + word) * wordBits + std::countr_zero(rest)));
+                }
+            }
+        });
+    }
+
+    void each(std::function<void(Entity, Component &)> func)
+    {
+        eachEntity([&func](Entity entity) {
+            func(entity, instance);
+        });
+    }
+
+    void moveTo(IComponentTable &destination, const std::vector<std::pair<Entity, Entity>> &mapping) override
+    {
+        auto &other = static_cast<ComponentTable &>(destination);
+        for (const auto &[from, to] : mapping) {
+            if (has(from)) {
+                other.add(to, instance);
+                remove(from);
+            }
+        }
+    }
+
+    bool serialize(Entity entity, std::vector<std::byte> &) const override { return has(entity); }
+
+    void deserialize(Entity entity, std::span<const std::byte>) override { add(entity, instance); }
+
+    std::size_t serializedSize() const override { return 0; }
+
+    TableStats stats() const override
+    {
+        TableStats stats = baseStats();
+        stats.entities = count;
+        stats.capacity = bits.capacity() * wordBits;
+        stats.bytesUsed = bits.capacity() * sizeof(std::uint64_t);
+        stats.bytesReserved += bits.bytes();
+        stats.fragmentation = stats.capacity ? 1.0f - float(count) / float(stats.capacity) : 0.0f;
+        return stats;
+    }
+
+    void shrinkToFit() override { bits.shrinkToFit(); }
+
+    void print(std::ostream &os) const override
+    {
+        os << "{ ";
+        eachEntity([&os](Entity entity) {
+            os << entity << " ";
+        });
+        os << "}";
+    }
+};
+
+// Tables of columnar components (DERIVE_COLUMNS) store every field in its own array, in blocks of
+// `width` entities: block b holds the fields of the entities in slots [b * width, (b + 1) * width)
+// Slots are dense, removing an entity moves the last one in its slot. get() returns a Component::Ref
+// proxy, valid until the table version changes: add, remove, reserve() or shrinkToFit().
+// The id -> slot index is paged (PagedArray.hpp), so it only takes memory for the range of live ids.
+template<typename Component>
+    requires Columnar<Component>
+class ComponentTable<Component> : public ComponentTableBase<ComponentTable<Component>, Component> {
+private:
+    using Base = ComponentTableBase<ComponentTable, Component>;
+    friend Base;
+    using Base::added;
+    using Base::removed;
+    using Base::updated;
+    using Base::version;
+    using Base::baseStats;
+
+public:
+    static constexpr std::size_t width = 8;
+
+    using Ref = typename Component::Ref;
+    using Members = decltype(std::declval<Component &>().get_columns());
+
+private:
+    template<typename Fields>
+    struct BlockOf;
+
+    template<typename... Fields>
+    struct BlockOf<std::tuple<Fields &...>> {
+        using type = std::tuple<std::array<Fields, width>...>;
+    };
+
+public:
+    using Block = typename BlockOf<Members>::type;
+
+private:
+    static constexpr std::uint32_t npos = std::numeric_limits<std::uint32_t>::max();
+    static constexpr std::size_t fieldCount = std::tuple_size_v<Members>;
+
+    static constexpr std::size_t sparsePage = 1024;
+
+    PagedArray<std::uint32_t, sparsePage> sparse {npos}; // entity id -> slot
+    std::vector<Entity> dense;                           // slot -> entity
+    std::vector<Block> blocks;
+
+    std::uint32_t slotOf(Entity entity) const
+    {
+        return sparse.get(entity.getId());
+    }
+
+    template<std::size_t... Is>
+    Ref refAt(std::size_t slot, std::index_sequence<Is...>)
+    {
+        auto &block = blocks[slot / width];
+        return Ref {std::get<Is>(block)[slot % width]...};
+    }
+    Ref refAt(std::size_t slot) { return refAt(slot, std::make_index_sequence<fieldCount> {}); }
+
+    template<std::size_t... Is>
+    Component load(std::size_t slot, std::index_sequence<Is...>) const
+    {
+        Component component {};
+        auto members = component.get_columns();
+        const auto &block = blocks[slot / width];
+        ((std::get<Is>(members) = std::get<Is>(block)[slot % width]), ...);
+        return component;
+    }
+    Component loadAt(std::size_t slot) const { return load(slot, std::make_index_sequence<fieldCount> {}); }
+
+    template<std::size_t... Is>
+    void store(std::size_t slot, const Component &component, std::index_sequence<Is...>)
+    {
+        const auto members = component.get_columns();
+        auto &block = blocks[slot / width];
+        ((std::get<Is>(block)[slot % width] = std::get<Is>(members)), ...);
+    }
+    void storeAt(std::size_t slot, const Component &component)
+    {
+        store(slot, component, std::make_index_sequence<fieldCount> {});
+    }
+
+public:
+    ComponentTable() = default;
+    ~ComponentTable() override = default;
+    ComponentTable(const ComponentTable &other) = default;
+    ComponentTable(ComponentTable &&other) noexcept = default;
+    ComponentTable &operator=(const ComponentTable &other) = default;
+    ComponentTable &operator=(ComponentTable &&other) noexcept = default;
+
+    void add(Entity entity, const std::any &component) override
+    {
+        insert(entity, std::any_cast<Component>(component));
+    }
+    void insert(Entity entity, const Component &component)
+    {
+        std::uint32_t slot = slotOf(entity);
+        if (slot != npos) {
+            storeAt(slot, component);
+            updated(entity);
+            return;
+        }
+        slot = static_cast<std::uint32_t>(dense.size());
+        dense.push_back(entity);
+        if (slot / width >= blocks.size()) {
+            blocks.emplace_back();
+        }
+        sparse.at(entity.getId()) = slot;
+        sparse.retain(entity.getId());
+        storeAt(slot, component);
+        added(entity);
+    }
+    bool has(Entity entity) const { return slotOf(entity) != npos; }
+    // like the other tables, a missing component is default constructed
+    Ref get(Entity entity)
+    {
+        if (!has(entity)) {
+            insert(entity, Component {});
+        }
+        return refAt(slotOf(entity));
+    }
+    std::optional<Ref> tryGet(Entity entity)
+    {
+        const std::uint32_t slot = slotOf(entity);
+        return slot == npos ? std::nullopt : std::optional<Ref>(refAt(slot));
+    }
+    Component load(Entity entity) const { return loadAt(slotOf(entity)); }
+    std::vector<Entity> getEntities() const { return dense; }
+    void remove(Entity entity) override
+    {
+        const std::uint32_t slot = slotOf(entity);
+        if (slot == npos) {
+            return;
+        }
+        const std::size_t last = dense.size() - 1;
+        if (slot != last) {
+            storeAt(slot, loadAt(last));
+            dense[slot] = dense[last];
+            sparse.at(dense[slot].getId()) = slot;
+        }
+        dense.pop_back();
+        sparse.at(entity.getId()) = npos;
+        sparse.release(entity.getId());
+        removed(entity);
+    }
+    std::size_t size() const { return dense.size(); }
+    // the version also changes when the blocks are reallocated
+    void reserve(std::size_t count)
+    {
+        const Block *previous = blocks.data();
+        dense.reserve(count);
+        blocks.reserve((count + width - 1) / width);
+        // Refs point into the blocks, the queries caching them have to rebuild
+        version += blocks.data() != previous;
+    }
+
+    // raw columns for vectorized code, slot i is lane i % width of block i / width
+    // the last block is only filled up to size()
+    std::span<Block> getBlocks() { return {blocks.data(), (dense.size() + width - 1) / width}; }
+    std::span<const Entity> getSlots() const { return dense; }
+
+    template<typename Func>
+    void eachEntity(Func func) const
+    {
+        for (Entity entity : dense) {
+            func(entity);
+        }
+    }
+
+    void each(std::function<void(Entity, Ref)> func)
+    {
+        for (std::size_t slot = 0; slot < dense.size(); slot++) {
+            func(dense[slot], refAt(slot));
+        }
+    }
+
+    void moveTo(IComponentTable &destination, const std::vector<std::pair<Entity, Entity>> &mapping) override
+    {
+        auto &other = static_cast<ComponentTable &>(destination);
+        for (const auto &[from, to] : mapping) {
+            if (has(from)) {
+                other.insert(to, load(from));
+                remove(from);
+            }
+        }
+    }
+
+    bool serialize(Entity entity, std::vector<std::byte> &out) const override
+    {
+        if (!has(entity)) {
+            return false;
+        }
+        if constexpr (std::is_trivially_copyable_v<Component>) {
+            const Component component = load(entity);
+            const auto *bytes = reinterpret_cast<const std::byte *>(&component);
+            out.insert(out.end(), bytes, bytes + sizeof(Component));
+            return true;
+        } else {
+            throw std::runtime_error("Component is not trivially copyable");
+        }
+    }
+
+    void deserialize(Entity entity, std::span<const std::byte> data) override
+    {
+        if constexpr (std::is_trivially_copyable_v<Component>) {
+            if (data.size() != sizeof(Component)) {
+                throw std::runtime_error("Invalid component size");
+            }
+            Component component {};
+            std::memcpy(&component, data.data(), sizeof(Component));
+            insert(entity, component);
+        } else {
+            throw std::runtime_error("Component is not trivially copyable");
+        }
+    }
+
+    std::size_t serializedSize() const override { return sizeof(Component); }
+
+    TableStats stats() const override
+    {
+        TableStats stats = baseStats();
+        stats.entities = dense.size();
+        stats.capacity = blocks.capacity() * width;
+        stats.bytesUsed = dense.size() * sizeof(Component);
+        stats.bytesReserved += blocks.capacity() * sizeof(Block) + dense.capacity() * sizeof(Entity) +
+                               entityNameBytes(dense) + sparse.bytes();
+        stats.fragmentation =
+            blocks.empty() ? 0.0f : 1.0f - float(dense.size()) / float(blocks.size() * width);
+        return stats;
+    }
+
+    void shrinkToFit() override
+    {
+        const Block *previous = blocks.data();
+        blocks.resize((dense.size() + width - 1) / width);
+        blocks.shrink_to_fit();
+        dense.shrink_to_fit();
+        sparse.shrinkToFit();
+        version += blocks.data() != previous;
+    }
+
+    void print(std::ostream &os) const override
+    {
+        os << "{\n";
+        for (std::size_t slot = 0; slot < dense.size(); slot++) {
+            os << dense[slot] << ": " << loadAt(slot) << "\n";
+        }
+        os << "}";
     }
 };
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <cstddef>
 #include <string>
 
 #ifdef DEBUG
@@ -28,6 +29,11 @@ public:
 
 #ifdef DEBUG
     operator std::string() const { return name; }
+    // heap buffer of the name, once it doesn't fit in the small string buffer
+    std::size_t nameBytes() const
+    {
+        return name.capacity() > std::string().capacity() ? name.capacity() + 1 : 0;
+    }
     DERIVE_DEBUG(Entity, id, name)
 #endif
 
@@ -47,3 +53,17 @@ struct hash<Entity> {
     }
 };
 }
+
+// memory held by the entities outside of sizeof(Entity): the names of a DEBUG build that are too long
+// for the small string buffer, 0 otherwise (the pending observer lists don't count it)
+template<typename Entities>
+std::size_t entityNameBytes([[maybe_unused]] const Entities &entities)
+{
+    std::size_t total = 0;
+#ifdef DEBUG
+    for (const Entity &entity : entities) {
+        total += entity.nameBytes();
+    }
+#endif
+    return total;
+}
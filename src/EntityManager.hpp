@@ -1,36 +1,95 @@
 
 #pragma once
 
-#include <atomic>
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
 #include <string>
 #include <vector>
-#include <algorithm>
 
 #include "Entity.hpp"
+#include "PagedArray.hpp"
 
 // creates, destroys, and manages entities
+// ids are only unique within one manager, so each World has its own sequence
+// isAlive() is the only place that decides whether a handle is still valid: ids are never reused for
+// now, recycling them would need a generation in Entity, compared there.
 class EntityManager {
 private:
+    static constexpr std::size_t wordBits = 64;
+
     std::vector<Entity> entities;
+    PagedArray<std::uint64_t, 64> alive; // one bit per id, pages without live entities are freed
+    std::size_t nextId = 0;
+
+    void kill(Entity entity)
+    {
+        const std::size_t word = entity.getId() / wordBits;
+        const std::uint64_t mask = std::uint64_t {1} << (entity.getId() % wordBits);
+        if (alive.get(word) & mask) {
+            alive.at(word) &= ~mask;
+            alive.release(word);
+        }
+    }
 
 public:
     EntityManager() = default;
 
     Entity create(const std::string &name = "unknown")
     {
-        static std::atomic<std::size_t> id = 0;
-        entities.emplace_back(id);
-        return Entity(id++, name);
+        entities.emplace_back(nextId);
+        alive.at(nextId / wordBits) |= std::uint64_t {1} << (nextId % wordBits);
+        alive.retain(nextId / wordBits);
+        return Entity(nextId++, name);
+    }
+
+    bool isAlive(Entity entity) const
+    {
+        return (alive.get(entity.getId() / wordBits) >> (entity.getId() % wordBits)) & 1;
     }
 
     void destroy(Entity entity)
     {
+        kill(entity);
         entities.erase(std::remove(entities.begin(), entities.end(), entity), entities.end());
     }
 
+    // destroys a batch of entities in a single pass over the entity list
+    void destroy(std::vector<Entity> batch)
+    {
+        for (Entity entity : batch) {
+            kill(entity);
+        }
+        std::sort(batch.begin(), batch.end(), [](Entity a, Entity b) {
+            return a.getId() < b.getId();
+        });
+        auto removed = std::remove_if(entities.begin(), entities.end(), [&batch](Entity entity) {
+            return std::binary_search(batch.begin(), batch.end(), entity, [](Entity a, Entity b) {
+                return a.getId() < b.getId();
+            });
+        });
+        entities.erase(removed, entities.end());
+    }
+
     const std::vector<Entity> &getEntities() const { return entities; }
 
     void clear() { entities.clear(); }
 
     size_t size() const { return entities.size(); }
+
+    size_t capacity() const { return entities.capacity(); }
+
+    // entity list and alive bits
+    size_t bytes() const
+    {
+        return entities.capacity() * sizeof(Entity) + entityNameBytes(entities) + alive.bytes();
+    }
+
+    void reserve(size_t count) { entities.reserve(count); }
+
+    void shrinkToFit()
+    {
+        entities.shrink_to_fit();
+        alive.shrinkToFit();
+    }
 };
@@ -0,0 +1,62 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <vector>
+
+#include "Entity.hpp"
+
+// Entities of a table sorted by id, for the ordered views of the deterministic mode
+// Only maintained once it has been asked for. New entities get the highest ids, so adding them only
+// appends, and removals are compacted on the next get(): the list is only sorted again when a component
+// is added to an older entity.
+class EntityOrder {
+private:
+    std::vector<Entity> entities;
+    bool tracking = false;
+    bool sorted = true;
+    bool removed = false;
+
+public:
+    void insert(Entity entity)
+    {
+        if (!tracking) {
+            return;
+        }
+        if (!entities.empty() && entities.back().getId() >= entity.getId()) {
+            sorted = false;
+        }
+        entities.push_back(entity);
+    }
+
+    void remove() { removed = tracking; }
+
+    std::size_t bytes() const { return entities.capacity() * sizeof(Entity) + entityNameBytes(entities); }
+
+    // has(entity) tells if the entity is still in the table, eachEntity(func) visits all of them
+    template<typename Has, typename EachEntity>
+    const std::vector<Entity> &get(Has has, EachEntity eachEntity)
+    {
+        if (!tracking) {
+            tracking = true;
+            eachEntity([this](Entity entity) {
+                entities.push_back(entity);
+            });
+            sorted = false;
+        } else if (removed) {
+            std::erase_if(entities, [&has](Entity entity) {
+                return !has(entity);
+            });
+        }
+        removed = false;
+        if (!sorted) {
+            // an entity removed then added again is in the list twice
+            std::sort(entities.begin(), entities.end(), [](Entity a, Entity b) {
+                return a.getId() < b.getId();
+            });
+            entities.erase(std::unique(entities.begin(), entities.end()), entities.end());
+            sorted = true;
+        }
+        return entities;
+    }
+};
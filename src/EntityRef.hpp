@@ -0,0 +1,38 @@
+
+#pragma once
+
+#include "World.hpp"
+
+// Entity reference that stays safe to use when the entity or its components disappear,
+// e.g. across the suspension points of an async system.
+// valid() only relies on World::isAlive(), not on how ids are versioned: once the entity is destroyed
+// (or migrated) the reference is stale, and stays so as long as isAlive() tells the handle apart from
+// a later entity reusing its id.
+class EntityRef {
+private:
+    World *world;
+    Entity entity;
+
+public:
+    EntityRef(World &world, Entity entity):
+        world(&world),
+        entity(entity)
+    {
+    }
+
+    bool valid() const { return world->isAlive(entity); }
+
+    Entity getEntity() const { return entity; }
+
+    // Component * (or std::optional<Component::Ref> for columnar components), empty when the entity
+    // is gone or doesn't have the component anymore
+    // the result must not be kept across a suspension point
+    template<ComponentType Component>
+    auto get() const -> decltype(world->getTable<Component>().tryGet(entity))
+    {
+        if (!valid()) {
+            return {};
+        }
+        return world->getTable<Component>().tryGet(entity);
+    }
+};
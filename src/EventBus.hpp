@@ -0,0 +1,200 @@
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <span>
+#include <stdexcept>
+#include <type_traits>
+#include <typeinfo>
+#include <unordered_map>
+#include <vector>
+
+// events are copied into preallocated slots, so they need to be default constructible
+template<class E>
+concept EventType = std::is_default_constructible_v<E> && std::is_copy_assignable_v<E>;
+
+class IEventChannel {
+public:
+    virtual ~IEventChannel() = default;
+
+    // publishes the events sent during the frame and recycles the other buffer
+    // must be called from a single thread, while no system is sending
+    virtual void update() = 0;
+    // memory held by the buffers, call it from the thread calling update()
+    virtual std::size_t bytes() const = 0;
+};
+
+// Double buffered queue of events of a single type
+// - send() can be called concurrently by any number of threads, it only does an atomic increment
+//   and a copy into a slot preallocated from the previous frames high water mark
+// - events sent during frame N are readable during frame N + 1
+// - once the capacity has settled, no allocation happens anymore
+template<EventType Event>
+class EventChannel : public IEventChannel {
+private:
+    std::vector<Event> buffers[2];
+    std::size_t readSize = 0;
+    std::size_t readStart = 0; // sequence number of the first readable event
+    std::size_t writeBuffer = 0;
+    std::atomic<std::size_t> writeCount = 0;
+
+    // only used when a frame sends more events than the preallocated slots
+    std::mutex overflowMutex;
+    std::vector<Event> overflow;
+
+public:
+    EventChannel(std::size_t capacity = 64)
+    {
+        buffers[0].resize(capacity);
+        buffers[1].resize(capacity);
+    }
+    ~EventChannel() override = default;
+    EventChannel(const EventChannel &other) = delete;
+    EventChannel(EventChannel &&other) noexcept = delete;
+    EventChannel &operator=(const EventChannel &other) = delete;
+    EventChannel &operator=(EventChannel &&other) noexcept = delete;
+
+    void send(const Event &event)
+    {
+        auto &buffer = buffers[writeBuffer];
+        const std::size_t slot = writeCount.fetch_add(1, std::memory_order_relaxed);
+        if (slot < buffer.size()) {
+            buffer[slot] = event;
+        } else {
+            std::lock_guard<std::mutex> lock(overflowMutex);
+            overflow.push_back(event);
+        }
+    }
+
+    void update() override
+    {
+        auto &written = buffers[writeBuffer];
+        const std::size_t count = writeCount.load(std::memory_order_acquire);
+        const std::size_t stored = std::min(count, written.size());
+
+        // overflowed events are appended after the slots, this is the only place that can grow a buffer
+        if (!overflow.empty()) {
+            written.resize(stored);
+            written.insert(written.end(), overflow.begin(), overflow.end());
+            overflow.clear();
+        }
+
+        readStart += readSize;
+        readSize = count;
+        writeBuffer ^= 1;
+        writeCount.store(0, std::memory_order_release);
+
+        // make the next write buffer big enough for this frames load
+        auto &next = buffers[writeBuffer];
+        if (next.size() < written.size()) {
+            next.resize(written.size());
+        }
+    }
+
+    // drops the published and pending events and sets the capacity, from the thread calling update()
+    // the sequence numbers keep increasing, so existing readers don't see old events again
+    void reset(std::size_t capacity)
+    {
+        readStart += readSize;
+        readSize = 0;
+        writeCount.store(0, std::memory_order_release);
+        overflow.clear();
+        buffers[0].assign(capacity, Event {});
+        buffers[1].assign(capacity, Event {});
+    }
+
+    // events published by the last update()
+    std::span<const Event> events() const { return {buffers[writeBuffer ^ 1].data(), readSize}; }
+
+    // sequence number of the first event returned by events()
+    std::size_t sequence() const { return readStart; }
+
+    std::size_t capacity() const { return buffers[writeBuffer].size(); }
+
+    std::size_t bytes() const override
+    {
+        return (buffers[0].capacity() + buffers[1].capacity() + overflow.capacity()) * sizeof(Event);
+    }
+};
+
+// Independent cursor over a channel, each reader sees every event once
+// events not read before the next update() are lost for this reader
+template<EventType Event>
+class EventReader {
+private:
+    std::size_t cursor = 0;
+
+public:
+    std::span<const Event> read(const EventChannel<Event> &channel)
+    {
+        auto events = channel.events();
+        const std::size_t start = channel.sequence();
+        const std::size_t skip = cursor > start ? std::min(cursor - start, events.size()) : 0;
+        cursor = start + events.size();
+        return events.subspan(skip);
+    }
+};
+
+// registry of the event channels, keyed by event type like the World component tables
+class EventBus {
+private:
+    std::unordered_map<std::size_t, std::unique_ptr<IEventChannel>> channels;
+
+public:
+    EventBus() = default;
+
+    template<EventType Event>
+    EventBus &registerEvent(std::size_t capacity = 64)
+    {
+        auto &channel = channels[typeid(Event).hash_code()];
+        if (channel) {
+            // registering again resets the channel in place, the references to it stay valid
+            static_cast<EventChannel<Event> &>(*channel).reset(capacity);
+        } else {
+            channel = std::make_unique<EventChannel<Event>>(capacity);
+        }
+        return *this;
+    }
+
+    template<EventType Event>
+    EventChannel<Event> &getChannel()
+    {
+        auto it = channels.find(typeid(Event).hash_code());
+        if (it == channels.end()) {
+            throw std::runtime_error("Event not found");
+        }
+        return *static_cast<EventChannel<Event> *>(it->second.get());
+    }
+
+    template<EventType Event>
+    void send(const Event &event)
+    {
+        getChannel<Event>().send(event);
+    }
+
+    template<EventType Event>
+    std::span<const Event> read(EventReader<Event> &reader)
+    {
+        return reader.read(getChannel<Event>());
+    }
+
+    void update()
+    {
+        for (auto &[id, channel] : channels) {
+            channel->update();
+        }
+    }
+
+    std::size_t bytes() const
+    {
+        std::size_t total = 0;
+        for (const auto &[id, channel] : channels) {
+            total += channel->bytes();
+        }
+        return total;
+    }
+};
@@ -0,0 +1,120 @@
+
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <functional>
+#include <span>
+#include <unordered_set>
+#include <vector>
+
+#include "Entity.hpp"
+
+enum class ObserverEvent {
+    Add,
+    Remove,
+    Update,
+};
+
+// receives every entity of a batch at once, keeps derived indexes up to date in O(changes)
+using Observer = std::function<void(std::span<const Entity>)>;
+
+// Observers of one component table and the changes not dispatched yet
+// changes are only recorded when someone observes them, so unobserved tables pay nothing
+class ComponentObservers {
+private:
+    static constexpr std::size_t eventCount = 3;
+
+    struct Change {
+        Entity entity;
+        bool hadComponent; // before the first add or remove of the frame
+    };
+
+    std::vector<Observer> observers[eventCount];
+    // adds and removes, once per entity: the net change is known at dispatch time
+    std::vector<Change> changes;
+    std::unordered_set<std::size_t> changed;
+    std::vector<Entity> updates;
+    std::vector<Entity> batch;
+
+    bool observed(ObserverEvent event) const { return !observers[static_cast<std::size_t>(event)].empty(); }
+
+    void send(ObserverEvent event)
+    {
+        if (!batch.empty()) {
+            for (auto &observer : observers[static_cast<std::size_t>(event)]) {
+                observer(batch);
+            }
+        }
+        batch.clear();
+    }
+
+public:
+    void observe(ObserverEvent event, Observer observer)
+    {
+        observers[static_cast<std::size_t>(event)].push_back(std::move(observer));
+    }
+
+    // pending changes and batch buffers, the set nodes are approximated as a next pointer and the id
+    std::size_t bytes() const
+    {
+        const std::size_t setBytes =
+            changed.size() * (sizeof(void *) + sizeof(std::size_t)) + changed.bucket_count() * sizeof(void *);
+        const std::size_t entityBytes = (updates.capacity() + batch.capacity()) * sizeof(Entity);
+        return changes.capacity() * sizeof(Change) + entityBytes + setBytes;
+    }
+
+    void record(ObserverEvent event, Entity entity)
+    {
+        if (event == ObserverEvent::Update) {
+            if (observed(ObserverEvent::Update)) {
+                updates.push_back(entity);
+            }
+            return;
+        }
+        if (!observed(ObserverEvent::Add) && !observed(ObserverEvent::Remove)) {
+            return;
+        }
+        if (changed.insert(entity.getId()).second) {
+            changes.push_back(Change {entity, event == ObserverEvent::Remove});
+        }
+    }
+
+    // Sends the batches in remove, add, update order, each entity at most once per batch.
+    // Adds and removes are the net change of the frame, from the table state before the first change
+    // to the state at dispatch time: added then removed is not reported, removed then added again is
+    // reported as a remove followed by an add. Updates are only kept if the component is still there.
+    // Changes made by the observers themselves are dispatched at the next sync point.
+    template<typename Has>
+    void dispatch(Has has)
+    {
+        if (!changes.empty()) {
+            std::vector<Change> frame;
+            frame.swap(changes);
+            changed.clear();
+            for (const auto &change : frame) {
+                if (change.hadComponent) {
+                    batch.push_back(change.entity);
+                }
+            }
+            send(ObserverEvent::Remove);
+            for (const auto &change : frame) {
+                if (has(change.entity)) {
+                    batch.push_back(change.entity);
+                }
+            }
+            send(ObserverEvent::Add);
+        }
+        if (!updates.empty()) {
+            batch.swap(updates);
+            std::sort(batch.begin(), batch.end(), [](Entity a, Entity b) {
+                return a.getId() < b.getId();
+            });
+            batch.erase(std::unique(batch.begin(), batch.end()), batch.end());
+            std::erase_if(batch, [&has](Entity entity) {
+                return !has(entity);
+            });
+            send(ObserverEvent::Update);
+        }
+    }
+};
@@ -0,0 +1,131 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Array indexed by entity id, allocated by pages of PageSize values
+// Entity ids are never reused, so an array covering every id ever issued grows forever under churn.
+// Here only the pages holding live values are allocated: each page counts its live values (retain() and
+// release()), is freed with the last one, and the directory only spans the first to the last allocated page.
+// Memory follows the range of live ids, not the number of ids issued.
+template<typename T, std::size_t PageSize>
+class PagedArray {
+private:
+    std::vector<std::vector<T>> pages; // pages[i] covers the indices of page first + i, empty when freed
+    std::vector<std::uint32_t> live;   // retained values per page
+    std::size_t first = 0;
+    std::size_t allocated = 0;
+    T empty;
+
+    // removes the freed pages at both ends of the directory
+    void trim()
+    {
+        std::size_t leading = 0;
+        while (leading < pages.size() && pages[leading].empty()) {
+            leading++;
+        }
+        pages.erase(pages.begin(), pages.begin() + static_cast<std::ptrdiff_t>(leading));
+        live.erase(live.begin(), live.begin() + static_cast<std::ptrdiff_t>(leading));
+        first += leading;
+        while (!pages.empty() && pages.back().empty()) {
+            pages.pop_back();
+            live.pop_back();
+        }
+    }
+
+public:
+    explicit PagedArray(T empty = T {}):
+        empty(empty)
+    {
+    }
+
+    // value at index, or the empty value when its page isn't allocated
+    T get(std::size_t index) const
+    {
+        const std::size_t page = index / PageSize;
+        if (page < first || page - first >= pages.size() || pages[page - first].empty()) {
+            return empty;
+        }
+        return pages[page - first][index % PageSize];
+    }
+
+    // value at index, allocating its page filled with the empty value
+    // the page is only kept once one of its values is retained
+    T &at(std::size_t index)
+    {
+        const std::size_t page = index / PageSize;
+        if (pages.empty()) {
+            first = page;
+        } else if (page < first) {
+            pages.insert(pages.begin(), first - page, {});
+            live.insert(live.begin(), first - page, 0);
+            first = page;
+        }
+        if (page - first >= pages.size()) {
+            pages.resize(page - first + 1);
+            live.resize(page - first + 1, 0);
+        }
+        auto &values = pages[page - first];
+        if (values.empty()) {
+            values.assign(PageSize, empty);
+            allocated++;
+        }
+        return values[index % PageSize];
+    }
+
+    // the page of index holds one more live value, at(index) has to be called first
+    void retain(std::size_t index) { live[index / PageSize - first]++; }
+
+    // the page of index holds one less live value, and is freed when it was the last one
+    void release(std::size_t index)
+    {
+        const std::size_t page = index / PageSize - first;
+        if (--live[page] == 0) {
+            std::vector<T>().swap(pages[page]);
+            allocated--;
+            trim();
+        }
+    }
+
+    // calls func(firstIndex, values) for every allocated page by increasing index, values is a std::vector<T>
+    template<typename Func>
+    void eachPage(Func func) const
+    {
+        for (std::size_t page = 0; page < pages.size(); page++) {
+            if (!pages[page].empty()) {
+                func((first + page) * PageSize, pages[page]);
+            }
+        }
+    }
+
+    // values allocated in pages
+    std::size_t capacity() const { return allocated * PageSize; }
+
+    std::size_t bytes() const
+    {
+        return allocated * PageSize * sizeof(T) + pages.capacity() * sizeof(std::vector<T>) +
+               live.capacity() * sizeof(std::uint32_t);
+    }
+
+    // reserves the directory for indices up to count
+    void reserve(std::size_t count)
+    {
+        pages.reserve((count + PageSize - 1) / PageSize);
+        live.reserve((count + PageSize - 1) / PageSize);
+    }
+
+    void shrinkToFit()
+    {
+        // pages allocated by at() without anything retained in them
+        for (std::size_t page = 0; page < pages.size(); page++) {
+            if (!pages[page].empty() && live[page] == 0) {
+                std::vector<T>().swap(pages[page]);
+                allocated--;
+            }
+        }
+        trim();
+        pages.shrink_to_fit();
+        live.shrink_to_fit();
+    }
+};
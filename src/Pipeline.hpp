@@ -0,0 +1,246 @@
+
+#pragma once
+
+#include <cstddef>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+#include "View.hpp"
+#include "World.hpp"
+
+// component of a kernel parameter: Component & or Component::Ref
+template<typename T>
+struct ComponentOfTraits {
+    using type = T;
+};
+
+template<ColumnRef T>
+struct ComponentOfTraits<T> {
+    using type = typename T::Component;
+};
+
+template<typename T>
+using ComponentOf = typename ComponentOfTraits<std::remove_cvref_t<T>>::type;
+
+// Per entity kernel: a callable with the same signature as the View::each callbacks
+// [](Entity entity, CPosition::Ref pos, CCircle &circle) { ... }
+// the components it works on are read from its signature
+template<typename F>
+struct KernelTraits : KernelTraits<decltype(&F::operator())> {};
+
+template<typename C, typename... Args>
+struct KernelTraits<void (C::*)(Entity, Args...) const> {
+    using Components = std::tuple<ComponentOf<Args>...>;
+    using Filters = std::tuple<>;
+};
+
+template<typename C, typename... Args>
+struct KernelTraits<void (C::*)(Entity, Args...)> {
+    using Components = std::tuple<ComponentOf<Args>...>;
+    using Filters = std::tuple<>;
+};
+
+// kernel that only runs on entities passing view filters (tags, Without<>)
+template<typename Func, typename... Filters>
+struct Filtered {
+    Func func;
+
+    template<typename... Args>
+    void operator()(Entity entity, Args &&...args)
+    {
+        func(entity, std::forward<Args>(args)...);
+    }
+};
+
+template<typename Func, typename... ViewFilters>
+struct KernelTraits<Filtered<Func, ViewFilters...>> {
+    using Components = typename KernelTraits<Func>::Components;
+    using Filters = std::tuple<ViewFilters...>;
+};
+
+// filtered<Without<CStatic>>([](Entity entity, CPosition &pos) { ... })
+template<typename... Filters, typename Func>
+Filtered<Func, Filters...> filtered(Func func)
+{
+    return {std::move(func)};
+}
+
+template<typename F>
+concept Kernel = requires {
+    typename KernelTraits<F>::Components;
+    typename KernelTraits<F>::Filters;
+};
+
+template<typename T, typename... Ts>
+constexpr bool containsType = (std::is_same_v<T, Ts> || ...);
+
+template<typename Subset, typename Set>
+constexpr bool includesTypes = false;
+
+template<typename... Subset, typename... Set>
+constexpr bool includesTypes<std::tuple<Subset...>, std::tuple<Set...>> =
+    (containsType<Subset, Set...> && ...);
+
+// components of the kernels that the first one doesn't iterate, each type once
+template<typename Base, typename Extras, typename... Ts>
+struct ExtraComponents {
+    using type = Extras;
+};
+
+template<typename... Base, typename... Extras, typename T, typename... Ts>
+struct ExtraComponents<std::tuple<Base...>, std::tuple<Extras...>, T, Ts...> {
+    using Next = std::conditional_t<
+        containsType<T, Base..., Extras...>, std::tuple<Extras...>, std::tuple<Extras..., T>>;
+    using type = typename ExtraComponents<std::tuple<Base...>, Next, Ts...>::type;
+};
+
+template<typename Base, typename All>
+struct ExtraComponentsOf;
+
+template<typename Base, typename... All>
+struct ExtraComponentsOf<Base, std::tuple<All...>> {
+    using type = typename ExtraComponents<Base, std::tuple<>, All...>::type;
+};
+
+template<typename Filters>
+struct FilterComponents;
+
+template<typename... Filters>
+struct FilterComponents<std::tuple<Filters...>> {
+    using type = std::tuple<typename ViewTraits<Filters>::Component...>;
+};
+
+// every table a kernel reads, components and filters
+template<typename F>
+using KernelTables = decltype(std::tuple_cat(
+    std::declval<typename KernelTraits<F>::Components>(),
+    std::declval<typename FilterComponents<typename KernelTraits<F>::Filters>::type>()
+));
+
+template<typename T, typename... Ts>
+constexpr std::size_t indexOfType = 0;
+
+template<typename T, typename First, typename... Rest>
+constexpr std::size_t indexOfType<T, First, Rest...> =
+    std::is_same_v<T, First> ? 0 : 1 + indexOfType<T, Rest...>;
+
+// I-th argument of a pack, by reference
+template<std::size_t I, typename First, typename... Rest>
+decltype(auto) argumentAt(First &first, Rest &...rest)
+{
+    if constexpr (I == 0) {
+        return (first);
+    } else {
+        return argumentAt<I - 1>(rest...);
+    }
+}
+
+// Kernel called from the fused pass, with the components of the pass row:
+// ComponentRef<Base>... for the components of the first kernel, ComponentPtr<Extras>... for the others
+// The components are picked from the row by index at compile time, so every kernel call of the pass is
+// a direct call, without any tuple built per entity.
+template<typename Func, typename Components, typename Filters, typename Base, typename Extras>
+class BoundKernel;
+
+template<typename Func, typename... Components, typename... Filters, typename... Base, typename... Extras>
+class BoundKernel<
+    Func, std::tuple<Components...>, std::tuple<Filters...>, std::tuple<Base...>, std::tuple<Extras...>> {
+private:
+    // components shared with the pass are already known to be there
+    template<typename Component>
+    static bool hasComponent(ComponentPtr<Extras> &...extras)
+    {
+        if constexpr (containsType<Component, Base...>) {
+            return true;
+        } else {
+            return static_cast<bool>(argumentAt<indexOfType<Component, Extras...>>(extras...));
+        }
+    }
+
+    template<typename Filter>
+    static bool passes(ComponentPtr<Extras> &...extras)
+    {
+        return hasComponent<typename ViewTraits<Filter>::Component>(extras...) !=
+               ViewTraits<Filter>::excluded;
+    }
+
+    template<typename Component>
+    static ComponentRef<Component> component(ComponentRef<Base> &...base, ComponentPtr<Extras> &...extras)
+    {
+        if constexpr (containsType<Component, Base...>) {
+            return argumentAt<indexOfType<Component, Base...>>(base...);
+        } else {
+            return *argumentAt<indexOfType<Component, Extras...>>(extras...);
+        }
+    }
+
+public:
+    static void call(Func &func, Entity entity, ComponentRef<Base> &...base, ComponentPtr<Extras> &...extras)
+    {
+        if (!(passes<Filters>(extras...) && ...) || !(hasComponent<Components>(extras...) && ...)) {
+            return;
+        }
+        func(entity, component<Components>(base..., extras...)...);
+    }
+};
+
+template<typename F, typename Base, typename Extras>
+using BoundKernelFor =
+    BoundKernel<F, typename KernelTraits<F>::Components, typename KernelTraits<F>::Filters, Base, Extras>;
+
+// runs the pass on the pool when there is one
+template<typename... Base, typename... Extras, typename... Kernels>
+void fusedPass(
+    World &world, ThreadPool *pool, std::tuple<Base...> *, std::tuple<Extras...> *, Kernels &...kernels
+)
+{
+    auto row = [&](Entity entity, ComponentRef<Base>... components, ComponentPtr<Extras>... extras) {
+        (BoundKernelFor<Kernels, std::tuple<Base...>, std::tuple<Extras...>>::call(
+             kernels, entity, components..., extras...
+         ),
+         ...);
+    };
+    auto &query = world.getQuery<Base..., Optional<Extras>...>();
+    if (pool) {
+        query.parallelEach(*pool, row);
+    } else {
+        query.each(row);
+    }
+}
+
+template<typename First, typename... Rest>
+void fusedPass(World &world, ThreadPool *pool, First &first, Rest &...rest)
+{
+    using Base = typename KernelTraits<First>::Components;
+    static_assert(
+        (includesTypes<Base, typename KernelTraits<Rest>::Components> && ...),
+        "Fused kernels need to use all the components of the first kernel"
+    );
+    using All =
+        decltype(std::tuple_cat(std::declval<KernelTables<First>>(), std::declval<KernelTables<Rest>>()...));
+    using Extras = typename ExtraComponentsOf<Base, All>::type;
+    fusedPass(world, pool, static_cast<Base *>(nullptr), static_cast<Extras *>(nullptr), first, rest...);
+}
+
+// Runs several kernels in a single pass over the entities, in order for each entity:
+// fuse(world, movement.kernel(dt), collision.circleKernel(bounces))
+// gives the same result as running each kernel in its own pass, while loading every entity once.
+// The pass iterates the components of the first kernel, every other kernel has to use at least these
+// components (checked at compile time). The components and filters of the other kernels are cached as
+// Optional<> columns of the same query, so a pass over a stable world does no hash lookup.
+// Kernels must only touch the entity they are given, otherwise the pass order becomes visible.
+template<Kernel First, Kernel... Rest>
+void fuse(World &world, First first, Rest... rest)
+{
+    fusedPass(world, nullptr, first, rest...);
+}
+
+// Same pass as fuse(), with the entities split in chunks run on the pool (see Query::parallelEach()):
+// kernels are called concurrently for different entities. In deterministic mode the result is the same
+// as fuse() with any number of threads. Like with parallelEach(), kernels must not call markUpdated().
+template<Kernel First, Kernel... Rest>
+void parallelFuse(World &world, ThreadPool &pool, First first, Rest... rest)
+{
+    fusedPass(world, &pool, first, rest...);
+}
@@ -0,0 +1,210 @@
+
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "View.hpp"
+
+class IQuery {
+public:
+    virtual ~IQuery() = default;
+
+    // rebuilds the cache on the next use, in id order or not
+    virtual void setOrdered(bool enable) = 0;
+    // rebuilds the cache on the next use
+    virtual void invalidate() = 0;
+    // memory held by the cached rows
+    virtual std::size_t bytes() const = 0;
+};
+
+// Persistent View, owned by the World (World::getQuery<Components...>())
+// The matching entities and pointers to their components are cached, the cache is only rebuilt when
+// an entity was added to or removed from one of the tables of the query (the table version changed),
+// and once the tables stayed the same between two uses: while they keep changing, the query iterates
+// its View like getView() would, so churn never costs more than the uncached view.
+// Iterating a query over a stable world is a walk over a vector, without any hash lookup.
+// A row holds the entity and a pointer per component, or per field for the columnar ones (Ref), and so
+// can be bigger than the data it reaches (56 bytes for the 16 bytes of position and velocity of the
+// fused pass of the sim): the cache trades that memory traffic for the lookups of the view.
+// Components live in unordered_map nodes that never move. Columnar blocks move when they are reallocated
+// (add, remove, reserve() or shrinkToFit()), and these tables change their version every time, so the
+// cached pointers and Refs stay valid as long as the table versions don't change.
+template<typename... Components>
+class Query : public IQuery {
+private:
+    // what the callback gets for a view parameter P, and what the rows keep for it:
+    // pointers for regular components, the Ref proxies for the columnar ones, ComponentPtr for Optional<>
+    template<typename P>
+    using Given = std::conditional_t<
+        ViewTraits<P>::optional, ComponentPtr<typename ViewTraits<P>::Component>, ComponentRef<P>>;
+    template<typename P>
+    using Cached = std::conditional_t<ViewTraits<P>::optional || Columnar<P>, Given<P>, P *>;
+
+    template<typename P>
+    using DataPart = std::conditional_t<isViewData<P>, std::tuple<P>, std::tuple<>>;
+    using Data = decltype(std::tuple_cat(std::declval<DataPart<Components>>()...));
+
+    template<typename DataTuple>
+    struct Rows;
+
+    template<typename... DataParams>
+    struct Rows<std::tuple<DataParams...>> {
+        using Row = std::tuple<Entity, Cached<DataParams>...>;
+
+        static void append(std::vector<Row> &rows, Entity entity, Given<DataParams>... components)
+        {
+            rows.emplace_back(entity, cache<DataParams>(components)...);
+        }
+
+        template<typename Func>
+        static void call(Func &func, Row &row)
+        {
+            call(func, row, std::index_sequence_for<DataParams...> {});
+        }
+
+        template<typename Func, std::size_t... I>
+        static void call(Func &func, Row &row, std::index_sequence<I...>)
+        {
+            func(std::get<0>(row), uncache<DataParams>(std::get<I + 1>(row))...);
+        }
+    };
+
+    using Row = typename Rows<Data>::Row;
+    using Versions = std::array<std::uint64_t, sizeof...(Components)>;
+
+    View<Components...> view;
+    std::tuple<ViewTable<Components> &...> tables;
+    Versions versions {};
+    std::vector<Row> rows;
+    bool built = false;
+    Versions seen {}; // table versions at the last use with stale rows
+    bool seenValid = false;
+    std::size_t rebuilds = 0;
+
+    template<typename P>
+    static Cached<P> cache(Given<P> component)
+    {
+        if constexpr (std::is_same_v<Cached<P>, Given<P>>) {
+            return component;
+        } else {
+            return &component;
+        }
+    }
+
+    template<typename P>
+    static Given<P> uncache(Cached<P> &cached)
+    {
+        if constexpr (std::is_same_v<Cached<P>, Given<P>>) {
+            return cached;
+        } else {
+            return *cached;
+        }
+    }
+
+    Versions currentVersions() const
+    {
+        return std::apply(
+            [](const auto &...table) {
+                return Versions {table.getVersion()...};
+            },
+            tables
+        );
+    }
+
+public:
+    Query(bool ordered, ViewTable<Components> &...tables):
+        view(tables...),
+        tables(tables...)
+    {
+        view.setOrdered(ordered);
+    }
+
+    void setOrdered(bool enable) override
+    {
+        view.setOrdered(enable);
+        invalidate();
+    }
+
+    void invalidate() override
+    {
+        built = false;
+        seenValid = false;
+    }
+
+    std::size_t bytes() const override { return rows.capacity() * sizeof(Row); }
+
+    bool stale() const { return !built || currentVersions() != versions; }
+
+    // true when the rows can be used, rebuilding them if needed
+    // stale rows are only rebuilt once the tables didn't change since the previous use: under churn the
+    // query iterates its view directly instead of paying for a rebuild every time
+    bool refresh()
+    {
+        if (!stale()) {
+            return true;
+        }
+        const Versions current = currentVersions();
+        if (!seenValid || current != seen) {
+            seen = current;
+            seenValid = true;
+            return false;
+        }
+        rows.clear();
+        view.each([this](Entity entity, auto &...components) {
+            Rows<Data>::append(rows, entity, components...);
+        });
+        versions = current;
+        built = true;
+        rebuilds++;
+        return true;
+    }
+
+    // same callback as View::each()
+    template<typename Func>
+    void each(Func func)
+    {
+        if (!refresh()) {
+            view.each(func);
+            return;
+        }
+        for (auto &row : rows) {
+            Rows<Data>::call(func, row);
+        }
+    }
+
+    // same as View::parallelEach(), over the cached rows
+    // (in id order, and so independent of the number of threads, when the World is deterministic)
+    template<typename Func>
+    void parallelEach(ThreadPool &pool, Func func, std::size_t chunkSize = 1024)
+    {
+        if (!refresh()) {
+            view.parallelEach(pool, func, chunkSize);
+            return;
+        }
+        parallelChunks(pool, rows.size(), chunkSize, [&](std::size_t begin, std::size_t end) {
+            for (std::size_t i = begin; i < end; i++) {
+                Rows<Data>::call(func, rows[i]);
+            }
+        });
+    }
+
+    std::size_t size()
+    {
+        if (refresh()) {
+            return rows.size();
+        }
+        std::size_t count = 0;
+        view.each([&count](Entity, auto &&...) {
+            count++;
+        });
+        return count;
+    }
+
+    std::size_t getRebuilds() const { return rebuilds; }
+};
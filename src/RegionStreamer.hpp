@@ -0,0 +1,338 @@
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <exception>
+#include <filesystem>
+#include <fstream>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include "World.hpp"
+#include "components/CPosition.hpp"
+#include "utils/ThreadPool.hpp"
+#include "utils/bytes.hpp"
+
+struct StreamingStats {
+    std::size_t residentEntities = 0;
+    std::size_t residentBytes = 0; // World::stats().bytesReserved
+    std::size_t evictedCells = 0;  // pages on disk
+    std::size_t pendingLoads = 0;
+    std::size_t pagesWritten = 0;
+    std::size_t pagesLoaded = 0;
+    double lastLoadMs = 0.0; // from the load request to the entities being back in the world
+    double maxLoadMs = 0.0;
+    double averageLoadMs = 0.0;
+
+    friend std::ostream &operator<<(std::ostream &os, const StreamingStats &stats)
+    {
+        return os << "resident: " << stats.residentEntities << " entities, " << stats.residentBytes
+                  << " bytes, evicted cells: " << stats.evictedCells << ", pending loads: "
+                  << stats.pendingLoads << ", pages written/loaded: " << stats.pagesWritten << "/"
+                  << stats.pagesLoaded << ", load latency last/avg/max: " << stats.lastLoadMs << "/"
+                  << stats.averageLoadMs << "/" << stats.maxLoadMs << " ms";
+    }
+};
+
+// Streams the entities of a World in and out of memory, based on their CPosition
+// The world is split in square cells, only the cells around a focus point stay resident:
+// - entities in cells further than activeRadius + 1 cells are serialized to a page file per cell
+//   and destroyed from the world (the extra cell avoids thrashing at the border)
+// - evicted cells within activeRadius are read back on a background thread, and recreated in the
+//   world by the next update() (entities get new ids)
+// Entities without CPosition are never evicted. Pages use World::serializePage(), so they are only
+// readable by the same build and are meant as a cache for the running process, not as save files: every
+// streamer writes them to its own new subdirectory of the given directory, removed by the destructor.
+// I/O errors are rethrown by update(); a page that could not be written is kept in memory instead,
+// so its entities still come back.
+class RegionStreamer {
+private:
+    using Cell = std::int64_t;
+    using Clock = std::chrono::steady_clock;
+
+    struct LoadedPage {
+        Cell cell;
+        std::vector<std::byte> bytes;
+        Clock::time_point requested;
+    };
+
+    std::filesystem::path directory; // owned by this streamer
+    float cellSize;
+    int activeRadius;
+
+    std::unordered_set<Cell> evicted;
+    std::unordered_set<Cell> loading;
+
+    std::mutex loadedMutex;
+    std::vector<LoadedPage> loaded;
+    std::vector<std::string> ioErrors;
+
+    // pages that failed to be written, only used by the io thread
+    std::unordered_map<Cell, std::vector<std::byte>> unwritten;
+
+    StreamingStats counters;
+    double totalLoadMs = 0.0;
+
+    // a single thread keeps the writes and reads of a cell in order
+    // declared last so that its pending jobs are done before the rest is destroyed
+    ThreadPool io {1};
+
+    static Cell makeCell(int x, int y)
+    {
+        return (static_cast<Cell>(x) << 32) | static_cast<std::uint32_t>(y);
+    }
+    static int cellX(Cell cell) { return static_cast<int>(cell >> 32); }
+    static int cellY(Cell cell) { return static_cast<int>(static_cast<std::uint32_t>(cell)); }
+
+    Cell cellOf(float x, float y) const
+    {
+        return makeCell(
+            static_cast<int>(std::floor(x / cellSize)), static_cast<int>(std::floor(y / cellSize))
+        );
+    }
+
+    static int distance(Cell a, Cell b)
+    {
+        return std::max(std::abs(cellX(a) - cellX(b)), std::abs(cellY(a) - cellY(b)));
+    }
+
+    static std::filesystem::path createDirectory(const std::filesystem::path &parent)
+    {
+        static std::atomic<std::uint64_t> instances = 0;
+        std::filesystem::create_directories(parent);
+        const auto time = Clock::now().time_since_epoch().count();
+        while (true) {
+            const std::string name = "pages_" + std::to_string(time) + "_" + std::to_string(instances++);
+            if (std::filesystem::create_directory(parent / name)) {
+                return parent / name;
+            }
+        }
+    }
+
+    // called from the io thread
+    void ioError(const std::string &message)
+    {
+        std::lock_guard<std::mutex> lock(loadedMutex);
+        ioErrors.push_back(message);
+    }
+
+    // waits for the pending reads and writes, the io thread runs them in order
+    void waitForIo()
+    {
+        std::promise<void> done;
+        io.enqueue([&done] {
+            done.set_value();
+        });
+        done.get_future().wait();
+    }
+
+    std::filesystem::path pagePath(Cell cell) const
+    {
+        const std::string name = "cell_" + std::to_string(cellX(cell)) + "_" + std::to_string(cellY(cell));
+        return directory / (name + ".page");
+    }
+
+    // the World::serializePage() pages appended to the file of the cell, one per eviction
+    static void deserializePages(World &world, std::span<const std::byte> bytes)
+    {
+        std::size_t offset = 0;
+        while (offset < bytes.size()) {
+            world.deserializePage(bytes, offset);
+        }
+    }
+
+    // every page is applied even if one of them fails, the first error is rethrown at the end
+    void applyLoadedPages(World &world)
+    {
+        std::vector<LoadedPage> pages;
+        {
+            std::lock_guard<std::mutex> lock(loadedMutex);
+            pages.swap(loaded);
+        }
+        std::exception_ptr error;
+        for (const auto &page : pages) {
+            loading.erase(page.cell);
+            try {
+                deserializePages(world, page.bytes);
+            } catch (...) {
+                if (!error) {
+                    error = std::current_exception();
+                }
+            }
+            const auto latency = Clock::now() - page.requested;
+            const double ms = std::chrono::duration<double, std::milli>(latency).count();
+            counters.pagesLoaded++;
+            counters.lastLoadMs = ms;
+            counters.maxLoadMs = std::max(counters.maxLoadMs, ms);
+            totalLoadMs += ms;
+            counters.averageLoadMs = totalLoadMs / static_cast<double>(counters.pagesLoaded);
+        }
+        if (error) {
+            std::rethrow_exception(error);
+        }
+    }
+
+    void throwIoErrors()
+    {
+        std::vector<std::string> errors;
+        {
+            std::lock_guard<std::mutex> lock(loadedMutex);
+            errors.swap(ioErrors);
+        }
+        if (!errors.empty()) {
+            throw std::runtime_error("RegionStreamer: " + errors.front());
+        }
+    }
+
+    // io thread: appends a page to the file of the cell
+    void writePage(Cell cell, const std::vector<std::byte> &page)
+    {
+        const auto path = pagePath(cell);
+        std::error_code error;
+        const bool existed = std::filesystem::exists(path, error);
+        const auto previousSize = existed ? std::filesystem::file_size(path, error) : 0;
+        std::ofstream file(path, std::ios::binary | std::ios::app);
+        if (file.write(reinterpret_cast<const char *>(page.data()), page.size()) && file.flush()) {
+            return;
+        }
+        // drop what was partially written, the page stays in memory until the cell is loaded
+        file.close();
+        if (existed) {
+            std::filesystem::resize_file(path, previousSize, error);
+        } else {
+            std::filesystem::remove(path, error);
+        }
+        auto &kept = unwritten[cell];
+        kept.insert(kept.end(), page.begin(), page.end());
+        ioError("could not write " + path.string());
+    }
+
+    // io thread: reads and removes the file of the cell, with the pages that could not be written
+    LoadedPage readPage(Cell cell, Clock::time_point requested)
+    {
+        const auto path = pagePath(cell);
+        LoadedPage page {cell, {}, requested};
+        std::error_code error;
+        const auto size = std::filesystem::file_size(path, error);
+        const bool found = !error;
+        if (found) {
+            std::ifstream file(path, std::ios::binary);
+            page.bytes.resize(size);
+            if (!file.read(reinterpret_cast<char *>(page.bytes.data()), page.bytes.size())) {
+                page.bytes.clear();
+                ioError("could not read " + path.string());
+            }
+            file.close();
+            std::filesystem::remove(path, error);
+        }
+        if (auto kept = unwritten.find(cell); kept != unwritten.end()) {
+            page.bytes.insert(page.bytes.end(), kept->second.begin(), kept->second.end());
+            unwritten.erase(kept);
+        } else if (!found) {
+            ioError("missing page " + path.string());
+        }
+        return page;
+    }
+
+    void requestLoads(Cell focus)
+    {
+        for (auto it = evicted.begin(); it != evicted.end();) {
+            const Cell cell = *it;
+            if (distance(cell, focus) > activeRadius) {
+                ++it;
+                continue;
+            }
+            it = evicted.erase(it);
+            loading.insert(cell);
+            io.enqueue([this, cell, requested = Clock::now()] {
+                LoadedPage page = readPage(cell, requested);
+                std::lock_guard<std::mutex> lock(loadedMutex);
+                loaded.push_back(std::move(page));
+            });
+        }
+    }
+
+    void evictFarCells(World &world, Cell focus)
+    {
+        std::unordered_map<Cell, std::vector<Entity>> far;
+        world.getView<CPosition>().each([&](Entity entity, const auto &pos) {
+            const Cell cell = cellOf(pos.x, pos.y);
+            // entities walking into a cell being loaded wait for the load to be done
+            if (distance(cell, focus) > activeRadius + 1 && !loading.contains(cell)) {
+                far[cell].push_back(entity);
+            }
+        });
+
+        for (auto &[cell, entities] : far) {
+            // appended to the file of the cell
+            auto page = std::make_shared<std::vector<std::byte>>();
+            world.serializePage(entities, *page);
+            world.destroyEntities(entities);
+            evicted.insert(cell);
+            counters.pagesWritten++;
+            io.enqueue([this, cell, page] {
+                writePage(cell, *page);
+            });
+        }
+    }
+
+public:
+    RegionStreamer(const std::filesystem::path &parent, float cellSize, int activeRadius):
+        directory(createDirectory(parent)),
+        cellSize(cellSize),
+        activeRadius(activeRadius)
+    {
+    }
+
+    // evicted entities that were not loaded back are lost with their pages
+    ~RegionStreamer()
+    {
+        waitForIo();
+        std::error_code error;
+        std::filesystem::remove_all(directory, error);
+    }
+
+    RegionStreamer(const RegionStreamer &other) = delete;
+    RegionStreamer &operator=(const RegionStreamer &other) = delete;
+
+    // call once per frame, from the thread updating the world
+    // throws after the update if a page could not be read, written or deserialized
+    void update(World &world, float focusX, float focusY)
+    {
+        const Cell focus = cellOf(focusX, focusY);
+        std::exception_ptr error;
+        try {
+            applyLoadedPages(world);
+        } catch (...) {
+            error = std::current_exception();
+        }
+        requestLoads(focus);
+        evictFarCells(world, focus);
+        if (error) {
+            std::rethrow_exception(error);
+        }
+        throwIoErrors();
+    }
+
+    const std::filesystem::path &getDirectory() const { return directory; }
+
+    StreamingStats stats(const World &world) const
+    {
+        StreamingStats stats = counters;
+        stats.residentEntities = world.getEntityCount();
+        stats.residentBytes = world.stats().bytesReserved;
+        stats.evictedCells = evicted.size();
+        stats.pendingLoads = loading.size();
+        return stats;
+    }
+};
@@ -0,0 +1,98 @@
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <optional>
+#include <span>
+#include <stdexcept>
+#include <vector>
+
+#include "utils/bytes.hpp"
+
+// one tick of a lockstep simulation: the commands applied before the tick, and the World::hash() after it
+struct TickRecord {
+    std::vector<std::byte> commands;
+    std::uint64_t hash = 0;
+};
+
+// Input/command log of a deterministic simulation, with a world hash per tick to detect desyncs
+// Commands are opaque bytes, their meaning is up to the simulation that records and replays them.
+//
+// recording: log.record(commands, world.hash()) after every tick
+// replaying: log.verify([&](std::span<const std::byte> commands) {
+//                apply(commands);
+//                tick();
+//                return world.hash();
+//            })
+class ReplayLog {
+private:
+    std::uint64_t seed = 0;
+    std::vector<TickRecord> ticks;
+
+public:
+    ReplayLog(std::uint64_t seed = 0):
+        seed(seed)
+    {
+    }
+
+    std::uint64_t getSeed() const { return seed; }
+
+    std::size_t size() const { return ticks.size(); }
+
+    const TickRecord &operator[](std::size_t tick) const { return ticks[tick]; }
+
+    void record(std::span<const std::byte> commands, std::uint64_t hash)
+    {
+        ticks.push_back(TickRecord {{commands.begin(), commands.end()}, hash});
+    }
+
+    // step(commands) has to apply the commands, run one tick and return the world hash
+    // returns the first tick whose hash differs from the recorded one
+    template<typename Step>
+    std::optional<std::size_t> verify(Step step) const
+    {
+        for (std::size_t tick = 0; tick < ticks.size(); tick++) {
+            if (step(std::span<const std::byte>(ticks[tick].commands)) != ticks[tick].hash) {
+                return tick;
+            }
+        }
+        return std::nullopt;
+    }
+
+    // [seed][tick count]([hash][command size][commands])...
+    void save(const std::filesystem::path &path) const
+    {
+        std::ofstream file(path, std::ios::binary);
+        writeBytes(file, seed);
+        writeBytes(file, static_cast<std::uint64_t>(ticks.size()));
+        for (const auto &tick : ticks) {
+            writeBytes(file, tick.hash);
+            writeBytes(file, static_cast<std::uint64_t>(tick.commands.size()));
+            file.write(reinterpret_cast<const char *>(tick.commands.data()), tick.commands.size());
+        }
+        if (!file) {
+            throw std::runtime_error("Could not write replay file");
+        }
+    }
+
+    static ReplayLog load(const std::filesystem::path &path)
+    {
+        std::ifstream file(path, std::ios::binary);
+        if (!file) {
+            throw std::runtime_error("Could not open replay file");
+        }
+        ReplayLog log(readBytes<std::uint64_t>(file));
+        log.ticks.resize(readBytes<std::uint64_t>(file));
+        for (auto &tick : log.ticks) {
+            tick.hash = readBytes<std::uint64_t>(file);
+            tick.commands.resize(readBytes<std::uint64_t>(file));
+            if (!file.read(reinterpret_cast<char *>(tick.commands.data()), tick.commands.size())) {
+                throw std::runtime_error("Truncated data");
+            }
+        }
+        return log;
+    }
+};
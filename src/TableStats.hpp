@@ -0,0 +1,49 @@
+
+#pragma once
+
+#include <cstddef>
+#include <ostream>
+#include <string>
+#include <vector>
+
+// memory and activity of a single component table
+struct TableStats {
+    std::string name;
+    std::size_t entities = 0;
+    std::size_t capacity = 0;      // entities the table can hold before growing
+    std::size_t bytesUsed = 0;     // component payload
+    std::size_t bytesReserved = 0; // everything allocated by the table (nodes, buckets, bits, id order...)
+    float fragmentation = 0.0f;    // 0 when dense, 1 - load factor for hash tables
+    std::size_t added = 0;         // during the last complete frame
+    std::size_t removed = 0;       // during the last complete frame
+
+    friend std::ostream &operator<<(std::ostream &os, const TableStats &stats)
+    {
+        return os << stats.name << ": " << stats.entities << "/" << stats.capacity << " entities, "
+                  << stats.bytesUsed << "/" << stats.bytesReserved << " bytes, fragmentation "
+                  << stats.fragmentation << ", +" << stats.added << " -" << stats.removed;
+    }
+};
+
+struct WorldStats {
+    std::vector<TableStats> tables;
+    std::size_t entities = 0;
+    std::size_t entityBytes = 0; // EntityManager storage
+    std::size_t queryBytes = 0;  // cached query rows
+    std::size_t eventBytes = 0;  // event channel buffers
+    std::size_t bytesUsed = 0;
+    std::size_t bytesReserved = 0;
+
+    friend std::ostream &operator<<(std::ostream &os, const WorldStats &stats)
+    {
+        os << "{\n";
+        for (const auto &table : stats.tables) {
+            os << table << "\n";
+        }
+        os << "entities: " << stats.entities << " (" << stats.entityBytes << " bytes)\n";
+        os << "queries: " << stats.queryBytes << " bytes, events: " << stats.eventBytes << " bytes\n";
+        os << "total: " << stats.bytesUsed << "/" << stats.bytesReserved << " bytes\n";
+        os << "}";
+        return os;
+    }
+};
@@ -1,52 +1,223 @@
 #pragma once
 
 #include "ComponentTable.hpp"
+#include "utils/ThreadPool.hpp"
+#include <algorithm>
+#include <exception>
+#include <latch>
+#include <mutex>
+#include <tuple>
+#include <type_traits>
+#include <vector>
+
+// View filter: only iterates entities that do NOT have the component T
+// world.getView<CPosition, CVelocity, Without<CStatic>>()
+template<typename T>
+struct Without {};
+
+// View parameter: iterates entities with or without the component T, the callback gets a
+// ComponentPtr<T> (T *, or std::optional<T::Ref> for columnar components) that is empty when it is missing
+// world.getView<CPosition, Optional<CCircle>>()
+template<typename T>
+struct Optional {};
+
+template<typename T>
+struct ViewTraits {
+    using Component = T;
+    static constexpr bool excluded = false;
+    static constexpr bool optional = false;
+};
+
+template<typename T>
+struct ViewTraits<Without<T>> {
+    using Component = T;
+    static constexpr bool excluded = true;
+    static constexpr bool optional = false;
+};
+
+template<typename T>
+struct ViewTraits<Optional<T>> {
+    using Component = T;
+    static constexpr bool excluded = false;
+    static constexpr bool optional = true;
+};
+
+template<typename T>
+using ViewTable = ComponentTable<typename ViewTraits<T>::Component>;
+
+// Types of the view that are given to the callback, tags and exclusions are only filters
+template<typename T>
+constexpr bool isViewData = ViewTraits<T>::optional || (!ViewTraits<T>::excluded && !std::is_empty_v<T>);
+
+// Runs func(begin, end) on the pool for every chunk of chunkSize indices in [0, count), and waits for them
+// The chunks only depend on count and chunkSize, not on the number of threads.
+// The first exception thrown by func is rethrown once every chunk is done.
+template<typename Func>
+void parallelChunks(ThreadPool &pool, std::size_t count, std::size_t chunkSize, Func func)
+{
+    const std::size_t chunks = (count + chunkSize - 1) / chunkSize;
+    std::latch done(static_cast<std::ptrdiff_t>(chunks));
+    std::exception_ptr error;
+    std::mutex errorMutex;
+
+    for (std::size_t chunk = 0; chunk < chunks; chunk++) {
+        pool.enqueue([&, chunk] {
+            try {
+                func(chunk * chunkSize, std::min(count, (chunk + 1) * chunkSize));
+            } catch (...) {
+                std::lock_guard<std::mutex> lock(errorMutex);
+                if (!error) {
+                    error = std::current_exception();
+                }
+            }
+            done.count_down();
+        });
+    }
+    done.wait();
+    if (error) {
+        std::rethrow_exception(error);
+    }
+}
 
 // class containing a reference to N componentTables, and makes it easy to iterate over them
 template<typename... Components>
 class View {
 private:
-    std::tuple<ComponentTable<Components> &...> tables;
+    std::tuple<ViewTable<Components> &...> tables;
+    bool ordered = false;
+
+    // the first table that is not an exclusion or optional drives the iteration
+    static constexpr std::size_t driverIndex()
+    {
+        constexpr bool filter[] = {(ViewTraits<Components>::excluded || ViewTraits<Components>::optional)...};
+        for (std::size_t i = 0; i < sizeof...(Components); i++) {
+            if (!filter[i]) {
+                return i;
+            }
+        }
+        return sizeof...(Components);
+    }
+    static_assert(driverIndex() < sizeof...(Components), "A view needs a non Without<>/Optional<> component");
+
+    template<std::size_t I>
+    bool matches(Entity entity) const
+    {
+        using T = std::tuple_element_t<I, std::tuple<Components...>>;
+        if constexpr (I == driverIndex() || ViewTraits<T>::optional) {
+            return true;
+        } else if constexpr (ViewTraits<T>::excluded) {
+            return !std::get<I>(tables).has(entity);
+        } else {
+            return std::get<I>(tables).has(entity);
+        }
+    }
+
+    template<std::size_t I>
+    auto get_component_for_entity(Entity entity) const
+    {
+        using T = std::tuple_element_t<I, std::tuple<Components...>>;
+        if constexpr (ViewTraits<T>::optional) {
+            using Component = typename ViewTraits<T>::Component;
+            return std::tuple<ComponentPtr<Component>>(std::get<I>(tables).tryGet(entity));
+        } else if constexpr (isViewData<T>) {
+            // the entity is known to have it, tryGet() doesn't insert so parallelEach() can call it
+            return std::tuple<ComponentRef<T>>(*std::get<I>(tables).tryGet(entity));
+        } else {
+            return std::tuple<>();
+        }
+    }
 
     template<std::size_t... Is>
-    auto
-    get_components_for_entity(Entity entity, std::index_sequence<Is...>) const -> std::tuple<Components &...>
+    auto get_components_for_entity(Entity entity, std::index_sequence<Is...>) const
     {
-        return std::tie(std::get<Is>(tables).get(entity)...);
+        return std::tuple_cat(get_component_for_entity<Is>(entity)...);
     }
 
     template<std::size_t... Is>
     bool entity_has_all_components(Entity entity, std::index_sequence<Is...>) const noexcept
     {
-        return (std::get<Is>(tables).has(entity) && ...);
+        return (matches<Is>(entity) && ...);
+    }
+
+    template<typename Func>
+    void visit(Entity entity, Func &func)
+    {
+        auto components = get_components_for_entity(entity, std::index_sequence_for<Components...> {});
+        std::apply(
+            [&](auto &...comps) {
+                func(entity, comps...);
+            },
+            components
+        );
+    }
+
+    bool matchesAll(Entity entity) const
+    {
+        return entity_has_all_components(entity, std::index_sequence_for<Components...> {});
+    }
+
+    // matching entities sorted by id, the driver table keeps its entities ordered between calls
+    std::vector<Entity> sortedEntities() const
+    {
+        std::vector<Entity> entities;
+        for (Entity entity : std::get<driverIndex()>(tables).orderedEntities()) {
+            if (matchesAll(entity)) {
+                entities.push_back(entity);
+            }
+        }
+        return entities;
     }
 
 public:
-    View(ComponentTable<Components> &...tables):
+    View(ViewTable<Components> &...tables):
         tables(tables...)
     {
     }
 
+    // iterates by increasing entity id instead of the table order (deterministic mode of the World)
+    View &setOrdered(bool enable)
+    {
+        ordered = enable;
+        return *this;
+    }
+
     // Should be used as follows:
     // auto view = world.getView<Component1, Component2, ...>();
     // view.each([](Entity entity, Component1 &c1, Component2 &c2, ...) {
     //     // do something with c1, c2, ...
     // });
+    // Empty components (tags) and Without<> filters are not passed to the callback,
+    // columnar components are given as Component::Ref instead of Component &,
+    // Optional<Component> as a ComponentPtr<Component> that is empty when the entity doesn't have it
     template<typename Func>
     void each(Func func)
     {
-        auto &first_table = std::get<0>(tables);
-        for (auto [entity, _] : first_table) {
-            if (entity_has_all_components(entity, std::index_sequence_for<Components...> {})) {
-                auto components =
-                    get_components_for_entity(entity, std::index_sequence_for<Components...> {});
-                std::apply(
-                    [&](auto &...comps) {
-                        func(entity, comps...);
-                    },
-                    components
-                );
+        if (ordered) {
+            for (Entity entity : sortedEntities()) {
+                visit(entity, func);
             }
+            return;
         }
+        std::get<driverIndex()>(tables).eachEntity([&](Entity entity) {
+            if (matchesAll(entity)) {
+                visit(entity, func);
+            }
+        });
+    }
+
+    // Same as each(), on a thread pool. The entities are sorted by id and split in chunks of chunkSize,
+    // so the partition doesn't depend on the number of threads: as long as func only modifies the
+    // entity it is given, the result is the same with any pool size, and the same as each().
+    // The first exception thrown by func is rethrown once every chunk is done.
+    // func must not add or remove components, nor call markUpdated(), tables are not synchronized.
+    template<typename Func>
+    void parallelEach(ThreadPool &pool, Func func, std::size_t chunkSize = 1024)
+    {
+        const std::vector<Entity> entities = sortedEntities();
+        parallelChunks(pool, entities.size(), chunkSize, [&](std::size_t begin, std::size_t end) {
+            for (std::size_t i = begin; i < end; i++) {
+                visit(entities[i], func);
+            }
+        });
     }
 };
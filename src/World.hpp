@@ -2,9 +2,18 @@
 #pragma once
 
 #include "EntityManager.hpp"
+#include <algorithm>
+#include <array>
+#include <bit>
 #include <cstddef>
+#include <cstdint>
+#include <cstring>
 #include <memory>
+#include <span>
+#include <string_view>
 #include <unordered_map>
+#include <unordered_set>
+#include <utility>
 #include <vector>
 
 #ifdef DEBUG
@@ -13,8 +22,12 @@
 
 #include "ComponentTable.hpp"
 #include "Entity.hpp"
+#include "EventBus.hpp"
+#include "Query.hpp"
+#include "TableStats.hpp"
 #include "EntityManager.hpp"
 #include "View.hpp"
+#include "utils/bytes.hpp"
 
 #ifdef DEBUG
 template<class C>
@@ -28,6 +41,10 @@ template<class C>
 concept ComponentType = true;
 #endif
 
+// component, tag or Without<component>
+template<class C>
+concept ViewParameter = ComponentType<typename ViewTraits<C>::Component>;
+
 
 // table for a specific component with the entity id as the key and the component as the value
 
@@ -41,6 +58,9 @@ private:
     std::unordered_map<size_t, std::string> names;
 #endif
     EntityManager entityManager;
+    EventBus events;
+    std::unordered_map<size_t, std::unique_ptr<IQuery>> queries;
+    bool deterministic = false;
 
 public:
     World() = default;
@@ -55,13 +75,270 @@ public:
         entityManager.destroy(entity);
     }
 
+    // moves the entities and all their components to destination, one pass per table
+    // the entities get new ids in destination, returned in the same order
+    // entities that aren't alive, or already listed before, are skipped (and not returned)
+    // destination has to be another world
+    std::vector<Entity> migrate(const std::vector<Entity> &entities, World &destination)
+    {
+        if (&destination == this) {
+            throw std::runtime_error("Cannot migrate entities to the same world");
+        }
+        std::vector<std::pair<Entity, Entity>> mapping;
+        std::vector<Entity> migrated;
+        std::unordered_set<Entity> seen;
+        mapping.reserve(entities.size());
+        migrated.reserve(entities.size());
+        for (Entity entity : entities) {
+            if (!isAlive(entity) || !seen.insert(entity).second) {
+                continue;
+            }
+#ifdef DEBUG
+            migrated.push_back(destination.createEntity(static_cast<std::string>(entity)));
+#else
+            migrated.push_back(destination.createEntity());
+#endif
+            mapping.emplace_back(entity, migrated.back());
+        }
+        for (auto &[id, table] : tables) {
+            auto &other = destination.tables[id];
+            if (!other) {
+                other = table->makeEmpty();
+#ifdef DEBUG
+                destination.names[id] = names[id];
+#endif
+            }
+            table->moveTo(*other, mapping);
+        }
+        entityManager.destroy(entities);
+        return migrated;
+    }
+
+    // destroys a batch of entities with a single pass over the entity list
+    void destroyEntities(const std::vector<Entity> &entities)
+    {
+        for (auto &[id, table] : tables) {
+            for (Entity entity : entities) {
+                table->remove(entity);
+            }
+        }
+        entityManager.destroy(entities);
+    }
+
+    // appends all the components of entity to out, as [count]([table id][size][bytes])...
+    // the table ids are type hashes, so the bytes can only be read back by the same build
+    void serialize(Entity entity, std::vector<std::byte> &out) const
+    {
+        const std::size_t countOffset = out.size();
+        std::uint32_t count = 0;
+        writeBytes(out, count);
+        for (const auto &[id, table] : tables) {
+            const std::size_t headerOffset = out.size();
+            writeBytes(out, static_cast<std::uint64_t>(id));
+            writeBytes(out, std::uint32_t {0});
+            if (!table->serialize(entity, out)) {
+                out.resize(headerOffset);
+                continue;
+            }
+            const std::size_t sizeOffset = headerOffset + sizeof(std::uint64_t);
+            const auto size = static_cast<std::uint32_t>(out.size() - sizeOffset - sizeof(std::uint32_t));
+            std::memcpy(out.data() + sizeOffset, &size, sizeof(size));
+            count++;
+        }
+        std::memcpy(out.data() + countOffset, &count, sizeof(count));
+    }
+
+    // creates a new entity from the bytes written by serialize()
+    // the data is checked before the entity is created, nothing is added to the world when it throws
+    Entity deserialize(std::span<const std::byte> data)
+    {
+        std::size_t offset = 0;
+        const auto count = readBytes<std::uint32_t>(data, offset);
+        std::vector<std::pair<IComponentTable *, std::span<const std::byte>>> components;
+        components.reserve(count);
+        for (std::uint32_t i = 0; i < count; i++) {
+            const auto id = readBytes<std::uint64_t>(data, offset);
+            const auto size = readBytes<std::uint32_t>(data, offset);
+            auto it = tables.find(static_cast<std::size_t>(id));
+            if (it == tables.end() || size != it->second->serializedSize() || offset + size > data.size()) {
+                throw std::runtime_error("Invalid serialized entity");
+            }
+            components.emplace_back(it->second.get(), data.subspan(offset, size));
+            offset += size;
+        }
+        Entity entity = createEntity();
+        try {
+            for (const auto &[table, bytes] : components) {
+                table->deserialize(entity, bytes);
+            }
+        } catch (...) {
+            destroyEntity(entity);
+            throw;
+        }
+        return entity;
+    }
+
+    // appends the components of entities to out as one page, smaller than serialize() per entity:
+    // [entity count][table count] then for every table holding a component of one of the entities
+    // [table id][component size][presence mask, one bit per entity][components of the present entities]
+    void serializePage(std::span<const Entity> entities, std::vector<std::byte> &out) const
+    {
+        const std::size_t countOffset = out.size();
+        writeBytes(out, static_cast<std::uint32_t>(entities.size()));
+        std::uint32_t tableCount = 0;
+        writeBytes(out, tableCount);
+        std::vector<std::uint64_t> mask((entities.size() + 63) / 64);
+        for (const auto &[id, table] : tables) {
+            const std::size_t headerOffset = out.size();
+            writeBytes(out, static_cast<std::uint64_t>(id));
+            writeBytes(out, static_cast<std::uint32_t>(table->serializedSize()));
+            const std::size_t maskOffset = out.size();
+            out.resize(maskOffset + mask.size() * sizeof(std::uint64_t));
+            std::fill(mask.begin(), mask.end(), 0);
+            bool present = false;
+            for (std::size_t i = 0; i < entities.size(); i++) {
+                if (table->serialize(entities[i], out)) {
+                    mask[i / 64] |= std::uint64_t {1} << (i % 64);
+                    present = true;
+                }
+            }
+            if (!present) {
+                out.resize(headerOffset);
+                continue;
+            }
+            std::memcpy(out.data() + maskOffset, mask.data(), mask.size() * sizeof(std::uint64_t));
+            tableCount++;
+        }
+        std::memcpy(out.data() + countOffset + sizeof(std::uint32_t), &tableCount, sizeof(tableCount));
+    }
+
+    // creates new entities from the page at offset written by serializePage(), and moves offset past it
+    // the whole page is checked before the entities are created, nothing is added to the world when it throws
+    std::vector<Entity> deserializePage(std::span<const std::byte> data, std::size_t &offset)
+    {
+        struct PageTable {
+            IComponentTable *table;
+            std::vector<std::uint64_t> mask;
+            std::span<const std::byte> components;
+        };
+        const auto count = readBytes<std::uint32_t>(data, offset);
+        const auto tableCount = readBytes<std::uint32_t>(data, offset);
+        const std::size_t words = (static_cast<std::size_t>(count) + 63) / 64;
+        std::vector<PageTable> pageTables;
+        pageTables.reserve(tableCount);
+        for (std::uint32_t t = 0; t < tableCount; t++) {
+            const auto id = readBytes<std::uint64_t>(data, offset);
+            const auto size = readBytes<std::uint32_t>(data, offset);
+            auto it = tables.find(static_cast<std::size_t>(id));
+            if (it == tables.end() || size != it->second->serializedSize()) {
+                throw std::runtime_error("Invalid serialized page");
+            }
+            PageTable &pageTable = pageTables.emplace_back(it->second.get());
+            std::size_t present = 0;
+            for (std::size_t w = 0; w < words; w++) {
+                pageTable.mask.push_back(readBytes<std::uint64_t>(data, offset));
+                present += static_cast<std::size_t>(std::popcount(pageTable.mask.back()));
+            }
+            if (count % 64 != 0 && pageTable.mask.back() >> (count % 64) != 0) {
+                throw std::runtime_error("Invalid serialized page");
+            }
+            if (offset + present * size > data.size()) {
+                throw std::runtime_error("Truncated data");
+            }
+            pageTable.components = data.subspan(offset, present * size);
+            offset += present * size;
+        }
+
+        std::vector<Entity> entities;
+        entities.reserve(count);
+        for (std::uint32_t i = 0; i < count; i++) {
+            entities.push_back(createEntity());
+        }
+        try {
+            for (const auto &[table, mask, components] : pageTables) {
+                const std::size_t size = table->serializedSize();
+                std::size_t componentOffset = 0;
+                for (std::size_t i = 0; i < count; i++) {
+                    if ((mask[i / 64] >> (i % 64)) & 1) {
+                        table->deserialize(entities[i], components.subspan(componentOffset, size));
+                        componentOffset += size;
+                    }
+                }
+            }
+        } catch (...) {
+            destroyEntities(entities);
+            throw;
+        }
+        return entities;
+    }
+
+    // Deterministic mode: views iterate by increasing entity id instead of the hash table order,
+    // so that a simulation fed with the same commands gives bit identical worlds on every run
+    // (see View::parallelEach() for the multithreaded version and Replay.hpp for desync detection)
+    void setDeterministic(bool enable)
+    {
+        deterministic = enable;
+        for (auto &[id, query] : queries) {
+            query->setOrdered(enable);
+        }
+    }
+
+    bool isDeterministic() const { return deterministic; }
+
+    // FNV-1a hash of every component of every entity, in table name then entity id order
+    // two worlds with the same hash have the same component bytes (padding included, so components
+    // hashed for desync detection should not have any)
+    std::uint64_t hash() const
+    {
+        std::vector<const IComponentTable *> sorted;
+        for (const auto &[id, table] : tables) {
+            sorted.push_back(table.get());
+        }
+        std::sort(sorted.begin(), sorted.end(), [](const IComponentTable *a, const IComponentTable *b) {
+            return std::string_view(a->name()) < std::string_view(b->name());
+        });
+
+        std::uint64_t hash = 14695981039346656037ULL;
+        auto mix = [&hash](std::span<const std::byte> bytes) {
+            for (std::byte byte : bytes) {
+                hash = (hash ^ static_cast<std::uint64_t>(byte)) * 1099511628211ULL;
+            }
+        };
+        std::vector<std::byte> bytes;
+        for (const IComponentTable *table : sorted) {
+            for (Entity entity : entityManager.getEntities()) {
+                bytes.clear();
+                if (!table->serialize(entity, bytes)) {
+                    continue;
+                }
+                const auto id = static_cast<std::uint64_t>(entity.getId());
+                std::array<std::byte, sizeof(id)> idBytes;
+                std::memcpy(idBytes.data(), &id, sizeof(id));
+                mix(idBytes);
+                mix(bytes);
+            }
+        }
+        return hash;
+    }
+
+    bool isAlive(Entity entity) const { return entityManager.isAlive(entity); }
+
     size_t getEntityCount() const { return entityManager.getEntities().size(); }
 
     template<ComponentType Component>
     World &registerComponent()
     {
         const size_t hash = typeid(Component).hash_code();
-        tables[hash] = std::make_unique<ComponentTable<Component>>();
+        auto &table = tables[hash];
+        if (table) {
+            // registering again empties the table in place, the queries keep referencing it
+            static_cast<ComponentTable<Component> &>(*table) = ComponentTable<Component>();
+            for (auto &[id, query] : queries) {
+                query->invalidate();
+            }
+        } else {
+            table = std::make_unique<ComponentTable<Component>>();
+        }
 #ifdef DEBUG
         names[hash] = typeid(Component).name();
 #endif
@@ -114,10 +391,100 @@ public:
         return *static_cast<ComponentTable<Component> *>(it->second.get());
     }
 
-    template<ComponentType... Component>
+    template<ViewParameter... Component>
     View<Component...> getView()
     {
-        return View<Component...>(getTable<Component>()...);
+        View<Component...> view(getTable<typename ViewTraits<Component>::Component>()...);
+        view.setOrdered(deterministic);
+        return view;
+    }
+
+    // Cached version of getView(), the query lives as long as the World
+    // prefer it for views iterated every frame, see Query.hpp
+    template<ViewParameter... Component>
+    Query<Component...> &getQuery()
+    {
+        auto &query = queries[typeid(Query<Component...>).hash_code()];
+        if (!query) {
+            query = std::make_unique<Query<Component...>>(
+                deterministic, getTable<typename ViewTraits<Component>::Component>()...
+            );
+        }
+        return static_cast<Query<Component...> &>(*query);
+    }
+
+    EventBus &getEvents() { return events; }
+
+    // observers of Component changes, batches are dispatched at the sync points
+    // (flushObservers() or endFrame()), never from inside add/remove
+    template<ComponentType Component>
+    World &observe(ObserverEvent event, Observer observer)
+    {
+        getTable<Component>().observe(event, std::move(observer));
+        return *this;
+    }
+
+    // components modified in place have to be marked for the update observers
+    // not thread safe, so not from the callbacks of a parallel pass (see ComponentTable::markUpdated())
+    template<ComponentType Component>
+    void markUpdated(Entity entity)
+    {
+        getTable<Component>().markUpdated(entity);
+    }
+
+    // sync point, dispatches the pending changes of every table to their observers
+    void flushObservers()
+    {
+        for (auto &[id, table] : tables) {
+            table->dispatchObservers();
+        }
+    }
+
+    // frame sync point, call once per frame after all the systems ran
+    void endFrame()
+    {
+        flushObservers();
+        for (auto &[id, table] : tables) {
+            table->endFrame();
+        }
+        events.update();
+    }
+
+    // memory usage of every table, the entities, the cached queries and the event buffers
+    // add/remove counts are the ones of the last complete frame
+    WorldStats stats() const
+    {
+        WorldStats stats;
+        for (const auto &[id, table] : tables) {
+            stats.tables.push_back(table->stats());
+            stats.bytesUsed += stats.tables.back().bytesUsed;
+            stats.bytesReserved += stats.tables.back().bytesReserved;
+        }
+        stats.entities = entityManager.size();
+        stats.entityBytes = entityManager.bytes();
+        for (const auto &[id, query] : queries) {
+            stats.queryBytes += query->bytes();
+        }
+        stats.eventBytes = events.bytes();
+        stats.bytesUsed += entityManager.size() * sizeof(Entity);
+        stats.bytesReserved += stats.entityBytes + stats.queryBytes + stats.eventBytes;
+        return stats;
+    }
+
+    // preallocates room for count entities in the Component table
+    template<ComponentType Component>
+    World &reserve(std::size_t count)
+    {
+        getTable<Component>().reserve(count);
+        return *this;
+    }
+
+    void shrinkToFit()
+    {
+        for (auto &[id, table] : tables) {
+            table->shrinkToFit();
+        }
+        entityManager.shrinkToFit();
     }
 
 #ifdef DEBUG
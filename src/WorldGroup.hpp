@@ -0,0 +1,54 @@
+
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+#include "View.hpp"
+#include "World.hpp"
+#include "utils/ThreadPool.hpp"
+
+// Set of independent worlds (one per match, map region, ...) ticked in parallel on a thread pool
+// worlds don't share any state, so each one can be updated by a different thread
+class WorldGroup {
+private:
+    std::vector<std::unique_ptr<World>> worlds;
+    ThreadPool pool;
+
+public:
+    WorldGroup(std::size_t numThreads = std::thread::hardware_concurrency()):
+        pool(std::max<std::size_t>(numThreads, 1))
+    {
+    }
+
+    // the returned reference stays valid until the world is removed
+    World &create()
+    {
+        worlds.push_back(std::make_unique<World>());
+        return *worlds.back();
+    }
+
+    void remove(std::size_t index) { worlds.erase(worlds.begin() + index); }
+
+    World &get(std::size_t index) { return *worlds[index]; }
+
+    std::size_t size() const { return worlds.size(); }
+
+    // calls func(world) for every world in parallel and waits for all of them
+    // the first exception thrown by func is rethrown once every world is done
+    template<typename Func>
+    void tick(Func func)
+    {
+        parallelChunks(pool, worlds.size(), 1, [&](std::size_t begin, std::size_t) {
+            func(*worlds[begin]);
+        });
+    }
+
+    // moves a batch of entities with all their components, must not be called during tick()
+    std::vector<Entity> migrate(std::size_t from, const std::vector<Entity> &entities, std::size_t to)
+    {
+        return worlds[from]->migrate(entities, *worlds[to]);
+    }
+};
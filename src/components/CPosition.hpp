@@ -1,10 +1,12 @@
 
 #pragma once
 
+#include "../utils/columns.hpp"
 #include "../utils/debug.hpp"
 
 struct CPosition {
     float x, y;
 
     DERIVE_DEBUG(CPosition, x, y)
+    DERIVE_COLUMNS(CPosition, x, y)
 };
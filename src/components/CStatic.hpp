@@ -0,0 +1,9 @@
+
+#pragma once
+
+#include "../utils/debug.hpp"
+
+// tag component, static entities are skipped by SMovement
+struct CStatic {
+    DERIVE_DEBUG(CStatic)
+};
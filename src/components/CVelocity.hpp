@@ -1,10 +1,12 @@
 
 #pragma once
 
+#include "../utils/columns.hpp"
 #include "../utils/debug.hpp"
 
 struct CVelocity {
     float vx, vy;
 
     DERIVE_DEBUG(CVelocity, vx, vy)
+    DERIVE_COLUMNS(CVelocity, vx, vy)
 };
@@ -6,3 +6,4 @@
 #include "CRectangle.hpp"
 #include "CVelocity.hpp"
 #include "CShapeColor.hpp"
+#include "CStatic.hpp"
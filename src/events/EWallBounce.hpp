@@ -0,0 +1,13 @@
+
+#pragma once
+
+#include "../Entity.hpp"
+#include "../utils/debug.hpp"
+
+// sent by SCollision when an entity bounces against the world bounds
+struct EWallBounce {
+    Entity entity {0};
+    float x, y;
+
+    DERIVE_DEBUG(EWallBounce, entity, x, y)
+};
@@ -0,0 +1,4 @@
+
+#pragma once
+
+#include "EWallBounce.hpp"
@@ -5,6 +5,8 @@
 #include "World.hpp"
 
 #include "components/components.hpp"
+#include "events/events.hpp"
+#include "systems/render.hpp"
 #include "systems/systems.hpp"
 
 
@@ -41,7 +43,9 @@ int main()
         .registerComponent<CVelocity>()
         .registerComponent<CCircle>()
         .registerComponent<CShapeColor>()
-        .registerComponent<CRectangle>();
+        .registerComponent<CRectangle>()
+        .registerComponent<CStatic>();
+    world.getEvents().registerEvent<EWallBounce>();
 
     auto ball_red = world.createEntity("ballRed");
     world.Entityadd(
@@ -57,6 +61,11 @@ int main()
         rec_blue, CPosition {200.0f, 300.0f}, CRectangle {40.0f, 60.0f}, CVelocity {50.0f, 50.0f},
         CShapeColor {0, 0, 255, 255}
     );
+    auto ball_static = world.createEntity("ballStatic");
+    world.Entityadd(
+        ball_static, CPosition {400.0f, 300.0f}, CVelocity {100.0f, 100.0f}, CCircle {10.0f},
+        CShapeColor {0, 0, 0, 255}, CStatic {}
+    );
     // generateBalls(world, 10000);
 
     SMovement movementSystem;
@@ -67,8 +76,13 @@ int main()
     while (!WindowShouldClose()) {
         // Update systems
         float deltaTime = GetFrameTime();
-        movementSystem.update(world, deltaTime);
-        collisionSystem.update(world);
+        auto &bounces = world.getEvents().getChannel<EWallBounce>();
+        // movementSystem.update() then collisionSystem.update(), in a single pass
+        fuse(
+            world, movementSystem.kernel(deltaTime), collisionSystem.circleKernel(bounces),
+            collisionSystem.rectangleKernel(bounces)
+        );
+        world.endFrame();
 
         BeginDrawing();
         {
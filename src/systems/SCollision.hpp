@@ -17,29 +17,53 @@ public:
     {
     }
 
-    void update(World &world)
+    // per entity kernels, can be fused with other kernels, see Pipeline.hpp
+    // send an EWallBounce event for every bounce
+    auto circleKernel(EventChannel<EWallBounce> &bounces) const
     {
-        auto view = world.getView<CPosition, CVelocity, CCircle>();
-        view.each([this](Entity entity, CPosition &pos, CVelocity &vel, CCircle &size) {
+        return [this, &bounces](Entity entity, CPosition::Ref pos, CVelocity::Ref vel, CCircle &size) {
+            bool bounced = false;
             if (pos.x - size.radius <= minX || pos.x + size.radius >= maxX) {
                 vel.vx = -vel.vx;
                 pos.x = std::clamp(pos.x, minX + size.radius, maxX - size.radius);
+                bounced = true;
             }
             if (pos.y - size.radius <= minY || pos.y + size.radius >= maxY) {
                 vel.vy = -vel.vy;
                 pos.y = std::clamp(pos.y, minY + size.radius, maxY - size.radius);
+                bounced = true;
+            }
+            if (bounced) {
+                bounces.send(EWallBounce {entity, pos.x, pos.y});
             }
-        });
-        auto view2 = world.getView<CPosition, CVelocity, CRectangle>();
-        view2.each([this](Entity entity, CPosition &pos, CVelocity &vel, CRectangle &size) {
+        };
+    }
+
+    auto rectangleKernel(EventChannel<EWallBounce> &bounces) const
+    {
+        return [this, &bounces](Entity entity, CPosition::Ref pos, CVelocity::Ref vel, CRectangle &size) {
+            bool bounced = false;
             if (pos.x <= minX || pos.x + size.width >= maxX) {
                 vel.vx = -vel.vx;
                 pos.x = std::clamp(pos.x, minX, maxX - size.width);
+                bounced = true;
             }
             if (pos.y <= minY || pos.y + size.height >= maxY) {
                 vel.vy = -vel.vy;
                 pos.y = std::clamp(pos.y, minY, maxY - size.height);
+                bounced = true;
             }
-        });
+            if (bounced) {
+                bounces.send(EWallBounce {entity, pos.x, pos.y});
+            }
+        };
+    }
+
+    // the EWallBounce event has to be registered in the world
+    void update(World &world)
+    {
+        auto &bounces = world.getEvents().getChannel<EWallBounce>();
+        fuse(world, circleKernel(bounces));
+        fuse(world, rectangleKernel(bounces));
     }
 };
\ No newline at end of file
@@ -5,12 +5,14 @@
 
 class SMovement {
 public:
-    void update(World &world, float deltaTime)
+    // per entity kernel, can be fused with other kernels, see Pipeline.hpp
+    static auto kernel(float deltaTime)
     {
-        auto view = world.getView<CPosition, CVelocity>();
-        view.each([deltaTime](Entity entity, CPosition &pos, CVelocity &vel) {
+        return filtered<Without<CStatic>>([deltaTime](Entity entity, CPosition::Ref pos, CVelocity::Ref vel) {
             pos.x += vel.vx * deltaTime;
             pos.y += vel.vy * deltaTime;
         });
     }
+
+    void update(World &world, float deltaTime) { fuse(world, kernel(deltaTime)); }
 };
@@ -0,0 +1,16 @@
+
+#pragma once
+
+#include "raylib.h"
+#include "systems.hpp"
+
+class SRenderRectangle {
+public:
+    void render(World &world)
+    {
+        auto &query = world.getQuery<CPosition, CRectangle, CShapeColor>();
+        query.each([](Entity entity, CPosition::Ref pos, CRectangle &size, CShapeColor &color) {
+            DrawRectangle(pos.x, pos.y, size.width, size.height, Color {color.r, color.g, color.b, color.a});
+        });
+    }
+};
@@ -0,0 +1,6 @@
+
+#pragma once
+
+// systems drawing with raylib, the logic systems in systems.hpp build without it
+#include "SRenderCircle.hpp"
+#include "SRenderRectangle.hpp"
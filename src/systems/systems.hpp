@@ -1,21 +1,10 @@
 
 #pragma once
 
+#include "../Pipeline.hpp"
 #include "../World.hpp"
 #include "../components/components.hpp"
+#include "../events/events.hpp"
 
 #include "SCollision.hpp"
 #include "SMovement.hpp"
-#include "SRenderCircle.hpp"
-#include "raylib.h"
-
-class SRenderRectangle {
-public:
-    void render(World &world)
-    {
-        auto view = world.getView<CPosition, CRectangle, CShapeColor>();
-        view.each([](Entity entity, CPosition &pos, CRectangle &size, CShapeColor &color) {
-            DrawRectangle(pos.x, pos.y, size.width, size.height, Color {color.r, color.g, color.b, color.a});
-        });
-    }
-};
@@ -0,0 +1,53 @@
+#pragma once
+
+#include <cstddef>
+#include <cstring>
+#include <istream>
+#include <ostream>
+#include <span>
+#include <stdexcept>
+#include <type_traits>
+#include <vector>
+
+// Raw byte (de)serialization of trivially copyable values, in the native layout and endianness:
+// the bytes are only meant to be read back by the same build (serialized entities, commands, replays)
+
+template<typename T>
+    requires std::is_trivially_copyable_v<T>
+void writeBytes(std::vector<std::byte> &out, const T &value)
+{
+    const auto *bytes = reinterpret_cast<const std::byte *>(&value);
+    out.insert(out.end(), bytes, bytes + sizeof(T));
+}
+
+template<typename T>
+    requires std::is_trivially_copyable_v<T>
+void writeBytes(std::ostream &out, const T &value)
+{
+    out.write(reinterpret_cast<const char *>(&value), sizeof(T));
+}
+
+// reads a T at offset and moves offset past it, throws if data is too short
+template<typename T>
+    requires std::is_trivially_copyable_v<T>
+T readBytes(std::span<const std::byte> data, std::size_t &offset)
+{
+    if (offset + sizeof(T) > data.size()) {
+        throw std::runtime_error("Truncated data");
+    }
+    T value;
+    std::memcpy(&value, data.data() + offset, sizeof(T));
+    offset += sizeof(T);
+    return value;
+}
+
+template<typename T>
+    requires std::is_trivially_copyable_v<T>
+T readBytes(std::istream &in)
+{
+    T value;
+    if (!in.read(reinterpret_cast<char *>(&value), sizeof(T))) {
+        throw std::runtime_error("Truncated data");
+    }
+    return value;
+}
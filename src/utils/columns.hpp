@@ -0,0 +1,53 @@
+
+#pragma once
+
+#include <tuple>
+
+// calls m(ClassName, field) for every field, up to 8 fields
+#define BECS_FOR_EACH_1(m, c, a) m(c, a)
+#define BECS_FOR_EACH_2(m, c, a, ...) m(c, a) BECS_FOR_EACH_1(m, c, __VA_ARGS__)
+#define BECS_FOR_EACH_3(m, c, a, ...) m(c, a) BECS_FOR_EACH_2(m, c, __VA_ARGS__)
+#define BECS_FOR_EACH_4(m, c, a, ...) m(c, a) BECS_FOR_EACH_3(m, c, __VA_ARGS__)
+#define BECS_FOR_EACH_5(m, c, a, ...) m(c, a) BECS_FOR_EACH_4(m, c, __VA_ARGS__)
+#define BECS_FOR_EACH_6(m, c, a, ...) m(c, a) BECS_FOR_EACH_5(m, c, __VA_ARGS__)
+#define BECS_FOR_EACH_7(m, c, a, ...) m(c, a) BECS_FOR_EACH_6(m, c, __VA_ARGS__)
+#define BECS_FOR_EACH_8(m, c, a, ...) m(c, a) BECS_FOR_EACH_7(m, c, __VA_ARGS__)
+#define BECS_GET_FOR_EACH(_1, _2, _3, _4, _5, _6, _7, _8, NAME, ...) NAME
+#define BECS_FOR_EACH(m, c, ...)                                                                          \
+    BECS_GET_FOR_EACH(                                                                                    \
+        __VA_ARGS__, BECS_FOR_EACH_8, BECS_FOR_EACH_7, BECS_FOR_EACH_6, BECS_FOR_EACH_5, BECS_FOR_EACH_4, \
+        BECS_FOR_EACH_3, BECS_FOR_EACH_2, BECS_FOR_EACH_1                                                 \
+    )                                                                                                     \
+    (m, c, __VA_ARGS__)
+
+#define BECS_COLUMN_REF(ClassName, field) decltype(ClassName::field) &field;
+#define BECS_COLUMN_LOAD(ClassName, field) value.field = field;
+#define BECS_COLUMN_STORE(ClassName, field) field = value.field;
+
+// Opt-in columnar storage: the table stores every field in its own array, in blocks of 8 entities (AoSoA)
+// Views and queries give a ClassName::Ref instead of a ClassName &, a proxy with a reference per field,
+// so systems still write pos.x += ...
+// Every field has to be listed, the table only reads and writes them through get_columns():
+// struct CPosition {
+//     float x, y;
+//     DERIVE_DEBUG(CPosition, x, y)
+//     DERIVE_COLUMNS(CPosition, x, y)
+// };
+#define DERIVE_COLUMNS(ClassName, ...)                                            \
+    inline auto get_columns() { return std::tie(__VA_ARGS__); }                   \
+    inline auto get_columns() const { return std::tie(__VA_ARGS__); }             \
+    struct Ref {                                                                  \
+        using Component = ClassName;                                              \
+        BECS_FOR_EACH(BECS_COLUMN_REF, ClassName, __VA_ARGS__)                    \
+        operator ClassName() const                                                \
+        {                                                                         \
+            ClassName value {};                                                   \
+            BECS_FOR_EACH(BECS_COLUMN_LOAD, ClassName, __VA_ARGS__)               \
+            return value;                                                         \
+        }                                                                         \
+        const Ref &operator=(const ClassName &value) const                        \
+        {                                                                         \
+            BECS_FOR_EACH(BECS_COLUMN_STORE, ClassName, __VA_ARGS__)              \
+            return *this;                                                         \
+        }                                                                         \
+    };
@@ -1,14 +1,38 @@
 add_rules("mode.debug", "mode.release")
    set_optimize("fastest")
 
-add_requires("raylib")
+option("raylib")
+    set_default(true)
+    set_showmenu(true)
+    set_description("Build the raylib demo (becs), disable it on machines without a display")
+option_end()
+
+if has_config("raylib") then
+    add_requires("raylib")
+end
+
 set_languages("c++20")
 
 add_rules("plugin.vsxmake.autoupdate")
 add_rules("plugin.compile_commands.autoupdate")
 
-target("becs")
+if has_config("raylib") then
+    target("becs")
+        set_kind("binary")
+        add_files("src/*.cpp")
+        add_packages("raylib")
+        -- add_defines("DEBUG")
+end
+
+target("becs_bench")
+    set_kind("binary")
+    add_files("bench/*.cpp")
+    add_includedirs("src")
+    add_syslinks("pthread")
+
+-- headless simulation, builds without raylib: xmake run becs_sim --balls 100000 --threads 8
+target("becs_sim")
     set_kind("binary")
-    add_files("src/*.cpp")
-    add_packages("raylib")
-    -- add_defines("DEBUG")
+    add_files("sim/*.cpp")
+    add_includedirs("src")
+    add_syslinks("pthread")